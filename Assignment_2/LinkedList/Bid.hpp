@@ -0,0 +1,132 @@
+//============================================================================
+// Name        : Bid.hpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Compact bid record shared by the bid containers
+//============================================================================
+
+#ifndef BID_HPP
+#define BID_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//============================================================================
+// Shared string storage
+//============================================================================
+
+/**
+ * Append-only arena holding each distinct bid title once, terminated by
+ * a '\0'. Titles are kept in fixed chunks that never move, so a handle,
+ * and a view returned by Get, stay valid for the life of the program;
+ * an index of the stored titles lets reloading a file reuse them rather
+ * than grow the arena. Handle 0 is the empty title.
+ *
+ * Intern takes a lock, so titles can be added from any thread. Get does
+ * not: the chunk table is a fixed array whose entries are only set
+ * before their first handle is handed out.
+ */
+class TitleArena {
+
+private:
+    static constexpr uint32_t CHUNK_BITS = 20;      // low bits of a handle, the offset
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = size_t(1) << (32 - CHUNK_BITS);
+
+    std::unique_ptr<char[]> chunks[MAX_CHUNKS];
+    size_t chunkCount;
+    size_t used;                                    // bytes taken in the last chunk
+    size_t bytes;
+    std::unordered_map<std::string_view, uint32_t> index;
+    mutable std::mutex lock;
+
+public:
+    TitleArena();
+    uint32_t Intern(std::string_view title);
+    std::string_view Get(uint32_t handle) const;
+    size_t Bytes() const;
+};
+
+/**
+ * Small dictionary of fund names. There are only a handful of funds, so
+ * each distinct name is stored once and a bid keeps a 16-bit id; id 0
+ * is the empty fund. Names are kept in fixed blocks and never move once
+ * added, so like the title arena only Intern needs the lock.
+ */
+class FundDictionary {
+
+private:
+    static constexpr uint32_t BLOCK_BITS = 8;       // low bits of an id, the place in its block
+    static constexpr size_t BLOCK_SIZE = size_t(1) << BLOCK_BITS;
+
+    std::unique_ptr<std::string[]> blocks[size_t(1) << (16 - BLOCK_BITS)];
+    size_t count;
+    std::unordered_map<std::string_view, uint16_t> ids;
+    mutable std::mutex lock;
+
+public:
+    FundDictionary();
+    uint16_t Intern(std::string_view fund);
+    const std::string& Get(uint16_t id) const;
+    size_t Size() const;
+};
+
+// the arena and dictionary every bid points into
+TitleArena& titleArena();
+FundDictionary& fundDictionary();
+
+//============================================================================
+// Bid record
+//============================================================================
+
+/**
+ * A bid in 24 bytes: the numeric auction id, the winning bid in cents,
+ * and handles to the shared title and fund strings. Key comparisons
+ * are integer compares.
+ */
+struct Bid {
+    int64_t cents;    // winning bid in cents
+    uint32_t bidId;   // unique identifier, 0 for an empty bid
+    uint32_t title;   // handle into titleArena()
+    uint16_t fund;    // id in fundDictionary()
+
+    Bid() {
+        cents = 0;
+        bidId = 0;
+        title = 0;
+        fund = 0;
+    }
+
+    Bid(uint32_t aBidId, std::string_view aTitle, std::string_view aFund, int64_t aCents);
+
+    std::string_view Title() const;
+    const std::string& Fund() const;
+    double Amount() const;
+};
+
+/**
+ * A bid whose strings still point at the text it was parsed from.
+ * Rows can be parsed into these on any thread, and turned into Bids
+ * on any thread too, as interning the strings takes a lock.
+ */
+struct ParsedBid {
+    int64_t cents;
+    uint32_t bidId;
+    std::string_view title;
+    std::string_view fund;
+
+    ParsedBid() {
+        cents = 0;
+        bidId = 0;
+    }
+};
+
+bool parseBidId(std::string_view text, uint32_t& bidId);
+
+#endif // BID_HPP
@@ -0,0 +1,459 @@
+//============================================================================
+// Name        : BidSnapshot.cpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Columnar binary snapshot of eBid data
+//============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include "BidSnapshot.hpp"
+
+using namespace std;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = { 'E', 'B', 'I', 'D', 'S', 'N', 'A', 'P' };
+
+/**
+ * Where Write puts everything after the header. Bytes are gathered into
+ * fixed blocks before they are written and hashed, so the checksum sees
+ * every piece but the last as a whole number of words.
+ */
+class SnapshotSink {
+
+private:
+    static const size_t BLOCK = 1 << 16;
+
+    ofstream& out;
+    vector<char> block;
+    size_t used;
+    uint64_t offset;        // in the file, of the next byte put
+    uint64_t hash;
+
+    void flush();
+
+public:
+    SnapshotSink(ofstream& aOut, uint64_t anOffset);
+    void Put(const void* data, size_t size);
+    void Align();
+    bool Copy(FILE* column, uint64_t bytes);
+    uint64_t Offset() const;
+    uint64_t Finish();
+};
+
+}
+
+/**
+ * FNV-1a taken over 64-bit words rather than bytes, so checking a
+ * snapshot at startup costs a fraction of a millisecond per megabyte.
+ * A long run can be hashed in pieces by passing each result on as the
+ * hash of the next piece, as long as every piece but the last is a
+ * whole number of words.
+ *
+ * @param data First byte to hash
+ * @param size Number of bytes to hash
+ * @param hash The hash of the pieces before this one
+ * @return The checksum
+ */
+uint64_t checksum(const char* data, size_t size, uint64_t hash) {
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    // trailing bytes one at a time
+    for (; i < size; i++) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Start putting bytes at an offset of the file
+ */
+SnapshotSink::SnapshotSink(ofstream& aOut, uint64_t anOffset) : out(aOut), block(BLOCK) {
+    used = 0;
+    offset = anOffset;
+    hash = CHECKSUM_SEED;
+}
+
+/**
+ * Write and hash the gathered bytes
+ */
+void SnapshotSink::flush() {
+    hash = checksum(block.data(), used, hash);
+    out.write(block.data(), used);
+    used = 0;
+}
+
+/**
+ * Add bytes to the file
+ */
+void SnapshotSink::Put(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        size_t piece = min(size, BLOCK - used);
+        memcpy(block.data() + used, bytes, piece);
+        used += piece;
+        offset += piece;
+        bytes += piece;
+        size -= piece;
+        if (used == BLOCK) {
+            flush();
+        }
+    }
+}
+
+/**
+ * Pad with zeroes up to the next 8 byte boundary
+ */
+void SnapshotSink::Align() {
+    static const char zeroes[8] = { 0 };
+    Put(zeroes, align8(offset) - offset);
+}
+
+/**
+ * Add the bytes of a column file, read from its start
+ *
+ * @return false if the file holds fewer bytes
+ */
+bool SnapshotSink::Copy(FILE* column, uint64_t bytes) {
+    if (fflush(column) != 0 || fseek(column, 0, SEEK_SET) != 0) {
+        return false;
+    }
+    while (bytes > 0) {
+        // read straight into the block, which is then flushed as Put would
+        size_t piece = static_cast<size_t>(min<uint64_t>(bytes, BLOCK - used));
+        if (fread(block.data() + used, 1, piece, column) != piece) {
+            return false;
+        }
+        used += piece;
+        offset += piece;
+        bytes -= piece;
+        if (used == BLOCK) {
+            flush();
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the file offset of the next byte
+ */
+uint64_t SnapshotSink::Offset() const {
+    return offset;
+}
+
+/**
+ * Write what is left, returning the checksum of all that was put
+ */
+uint64_t SnapshotSink::Finish() {
+    flush();
+    return hash;
+}
+
+/**
+ * Round an offset up to the next 8 byte boundary
+ */
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+/**
+ * Whether count items of width bytes fit between two file offsets. Only
+ * differences are taken, so offsets read from a damaged file cannot wrap
+ * the test around.
+ */
+bool sectionFits(uint64_t begin, uint64_t end, uint64_t count, uint64_t width) {
+    return begin <= end && count <= (end - begin) / width;
+}
+
+/**
+ * Size and last write time of the CSV a file is compiled from
+ */
+bool sourceStamp(const string& sourcePath, uint64_t& size, int64_t& time) {
+    error_code error;
+    filesystem::path source(sourcePath);
+
+    size = filesystem::file_size(source, error);
+    if (error) {
+        return false;
+    }
+    time = static_cast<int64_t>(filesystem::last_write_time(source, error).time_since_epoch().count());
+    return !error;
+}
+
+//============================================================================
+// Snapshot writer
+//============================================================================
+
+/**
+ * Default constructor. If the column files can't be made, bids are
+ * still accepted but Write refuses to produce a snapshot.
+ */
+BidSnapshotWriter::BidSnapshotWriter() {
+    ids = tmpfile();
+    cents = tmpfile();
+    titleOffsets = tmpfile();
+    titles = tmpfile();
+    fundOffsets = tmpfile();
+    funds = tmpfile();
+    count = 0;
+    titleBytes = 0;
+    fundBytes = 0;
+    complete = ids != nullptr && cents != nullptr && titleOffsets != nullptr && titles != nullptr
+            && fundOffsets != nullptr && funds != nullptr;
+}
+
+/**
+ * Destructor, the column files go away as they are closed
+ */
+BidSnapshotWriter::~BidSnapshotWriter() {
+    for (FILE* column : { ids, cents, titleOffsets, titles, fundOffsets, funds }) {
+        if (column != nullptr) {
+            fclose(column);
+        }
+    }
+}
+
+/**
+ * Add one bid to the end of every column
+ *
+ * @param bidId Numeric auction id
+ * @param amountCents Winning bid in cents
+ * @return false if the bid could not be kept, in which case no snapshot
+ *         will be written
+ */
+bool BidSnapshotWriter::Add(uint32_t bidId, int64_t amountCents, string_view title, string_view fund) {
+    // string offsets are stored as 32 bits
+    if (!complete
+            || titleBytes + title.size() > numeric_limits<uint32_t>::max()
+            || fundBytes + fund.size() > numeric_limits<uint32_t>::max()) {
+        complete = false;
+        return false;
+    }
+
+    titleBytes += title.size();
+    fundBytes += fund.size();
+    uint32_t titleEnd = static_cast<uint32_t>(titleBytes);
+    uint32_t fundEnd = static_cast<uint32_t>(fundBytes);
+
+    // stdio buffers the writes; one that failed shows when Write reads back
+    fwrite(&bidId, sizeof(bidId), 1, ids);
+    fwrite(&amountCents, sizeof(amountCents), 1, cents);
+    fwrite(title.data(), 1, title.size(), titles);
+    fwrite(&titleEnd, sizeof(titleEnd), 1, titleOffsets);
+    fwrite(fund.data(), 1, fund.size(), funds);
+    fwrite(&fundEnd, sizeof(fundEnd), 1, fundOffsets);
+    count++;
+    return true;
+}
+
+/**
+ * Returns the number of bids added so far
+ */
+size_t BidSnapshotWriter::Size() const {
+    return count;
+}
+
+/**
+ * Write the snapshot file. It is written next to its final name first
+ * and then renamed, so a reader never sees half a snapshot.
+ *
+ * @param path Where to write the snapshot
+ * @param sourcePath The CSV the bids came from, used to detect staleness
+ */
+void BidSnapshotWriter::Write(const string& path, const string& sourcePath) {
+    if (!complete || count > numeric_limits<uint32_t>::max()) {
+        throw SnapshotError("some bids could not be kept, no snapshot written");
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.count = static_cast<uint32_t>(count);
+    if (!sourceStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+        throw SnapshotError(string("can't stat ").append(sourcePath));
+    }
+
+    // the header is written again once the columns are down
+    string tempPath = path + ".tmp";
+    ofstream out(tempPath.c_str(), ios::out | ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // lay the columns out one after the other, each on an 8 byte boundary
+    const uint32_t zero = 0;
+    SnapshotSink sink(out, sizeof(header));
+    bool copied = true;
+
+    sink.Align();
+    header.idsOffset = sink.Offset();
+    copied = copied && sink.Copy(ids, count * sizeof(uint32_t));
+    sink.Align();
+    header.centsOffset = sink.Offset();
+    copied = copied && sink.Copy(cents, count * sizeof(int64_t));
+    sink.Align();
+    header.titleIndexOffset = sink.Offset();
+    sink.Put(&zero, sizeof(zero));
+    copied = copied && sink.Copy(titleOffsets, count * sizeof(uint32_t));
+    sink.Align();
+    header.titleHeapOffset = sink.Offset();
+    copied = copied && sink.Copy(titles, titleBytes);
+    sink.Align();
+    header.fundIndexOffset = sink.Offset();
+    sink.Put(&zero, sizeof(zero));
+    copied = copied && sink.Copy(fundOffsets, count * sizeof(uint32_t));
+    sink.Align();
+    header.fundHeapOffset = sink.Offset();
+    copied = copied && sink.Copy(funds, fundBytes);
+    header.fileSize = sink.Offset();
+    header.checksum = sink.Finish();
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!copied || !out) {
+        remove(tempPath.c_str());
+        throw SnapshotError(string("can't write ").append(tempPath));
+    }
+
+    // rename does not replace an existing file everywhere
+    remove(path.c_str());
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        remove(tempPath.c_str());
+        throw SnapshotError(string("can't write ").append(path));
+    }
+}
+
+//============================================================================
+// Snapshot reader
+//============================================================================
+
+/**
+ * Map a snapshot and check it
+ *
+ * @param path The snapshot file
+ * @param sourcePath The CSV it should match; when that file still
+ *        exists, a snapshot compiled from another version of it is
+ *        rejected as out of date
+ */
+BidSnapshot::BidSnapshot(const string& path, const string& sourcePath) {
+    try {
+        file = new csv::MappedFile(path);
+    } catch (csv::Error& e) {
+        throw SnapshotError(string("can't open ").append(path));
+    }
+
+    try {
+        validate(sourcePath);
+    } catch (SnapshotError& e) {
+        delete file;
+        throw;
+    }
+}
+
+/**
+ * Destructor
+ */
+BidSnapshot::~BidSnapshot() {
+    delete file;
+}
+
+/**
+ * Check the header, the section bounds and the checksum, then point the
+ * column pointers into the mapping
+ */
+void BidSnapshot::validate(const string& sourcePath) {
+    const char* data = file->data();
+    size_t size = file->size();
+
+    if (size < sizeof(SnapshotHeader)) {
+        throw SnapshotError("file is too short");
+    }
+    header = reinterpret_cast<const SnapshotHeader*>(data);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        throw SnapshotError("not a bid snapshot");
+    }
+    if (header->version != SNAPSHOT_VERSION) {
+        throw SnapshotError("unsupported snapshot version");
+    }
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (sourceStamp(sourcePath, sourceSize, sourceTime)
+            && (sourceSize != header->sourceSize || sourceTime != header->sourceTime)) {
+        throw SnapshotError("snapshot is out of date");
+    }
+
+    // every section must sit inside the file, in order and aligned; a bid
+    // takes at least 20 bytes, which bounds the count before it is used
+    uint64_t n = header->count;
+    if (header->fileSize != size
+            || n > size / (sizeof(uint32_t) + sizeof(int64_t) + 2 * sizeof(uint32_t))
+            || header->idsOffset < sizeof(SnapshotHeader)
+            || !sectionFits(header->idsOffset, header->centsOffset, n, sizeof(uint32_t))
+            || !sectionFits(header->centsOffset, header->titleIndexOffset, n, sizeof(int64_t))
+            || !sectionFits(header->titleIndexOffset, header->titleHeapOffset, n + 1, sizeof(uint32_t))
+            || header->titleHeapOffset > header->fundIndexOffset
+            || !sectionFits(header->fundIndexOffset, header->fundHeapOffset, n + 1, sizeof(uint32_t))
+            || header->fundHeapOffset > size
+            || ((header->idsOffset | header->centsOffset | header->titleIndexOffset
+                 | header->fundIndexOffset) & 7) != 0) {
+        throw SnapshotError("damaged snapshot layout");
+    }
+    if (checksum(data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) != header->checksum) {
+        throw SnapshotError("checksum mismatch");
+    }
+
+    ids = reinterpret_cast<const uint32_t*>(data + header->idsOffset);
+    cents = reinterpret_cast<const int64_t*>(data + header->centsOffset);
+    titleOffsets = reinterpret_cast<const uint32_t*>(data + header->titleIndexOffset);
+    titles = data + header->titleHeapOffset;
+    fundOffsets = reinterpret_cast<const uint32_t*>(data + header->fundIndexOffset);
+    funds = data + header->fundHeapOffset;
+
+    // string offsets must stay inside their heaps
+    if (titleOffsets[n] > header->fundIndexOffset - header->titleHeapOffset
+            || fundOffsets[n] > size - header->fundHeapOffset) {
+        throw SnapshotError("damaged snapshot layout");
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (titleOffsets[i] > titleOffsets[i + 1] || fundOffsets[i] > fundOffsets[i + 1]) {
+            throw SnapshotError("damaged snapshot layout");
+        }
+    }
+}
+
+/**
+ * Returns the number of bids in the snapshot
+ */
+size_t BidSnapshot::Size() const {
+    return header->count;
+}
+
+uint32_t BidSnapshot::BidId(size_t i) const {
+    return ids[i];
+}
+
+int64_t BidSnapshot::Cents(size_t i) const {
+    return cents[i];
+}
+
+string_view BidSnapshot::Title(size_t i) const {
+    return string_view(titles + titleOffsets[i], titleOffsets[i + 1] - titleOffsets[i]);
+}
+
+string_view BidSnapshot::Fund(size_t i) const {
+    return string_view(funds + fundOffsets[i], fundOffsets[i + 1] - fundOffsets[i]);
+}
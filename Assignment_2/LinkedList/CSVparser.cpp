@@ -1,10 +1,307 @@
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include <sstream>
 #include <iomanip>
 #include "CSVparser.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define CSV_SSE2
+# include <immintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define CSV_TARGET_AVX2
+# else
+#  define CSV_TARGET_AVX2 __attribute__((target("avx2")))
+# endif
+#endif
+
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
 namespace csv {
 
+  /*
+  ** SCANNER
+  **
+  ** Finds the delimiters of a buffer that are outside quotes, 64 bytes at
+  ** a time. Each block is turned into a bitmask of quotes and a bitmask of
+  ** delimiters (SSE2, or AVX2 when the CPU has it); a prefix XOR of the
+  ** quote mask gives the quoted regions, and the delimiters left outside
+  ** them are walked with count-trailing-zeros. Doubled quotes inside a
+  ** quoted field toggle twice, which is what the old byte loop did too.
+  */
+
+  namespace {
+
+    typedef void (*ClassifyFn)(const char *, char, std::uint64_t &, std::uint64_t &);
+
+#ifndef CSV_SSE2
+    void classifyScalar(const char *block, char delim, std::uint64_t &quotes, std::uint64_t &delims)
+    {
+        quotes = 0;
+        delims = 0;
+        for (unsigned int i = 0; i < 64; i++)
+        {
+            quotes |= static_cast<std::uint64_t>(block[i] == '"') << i;
+            delims |= static_cast<std::uint64_t>(block[i] == delim) << i;
+        }
+    }
+#else
+    void classifySSE2(const char *block, char delim, std::uint64_t &quotes, std::uint64_t &delims)
+    {
+        const __m128i q = _mm_set1_epi8('"');
+        const __m128i d = _mm_set1_epi8(delim);
+
+        quotes = 0;
+        delims = 0;
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+            std::uint32_t qm = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, q)));
+            std::uint32_t dm = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)));
+            quotes |= static_cast<std::uint64_t>(qm) << (16 * i);
+            delims |= static_cast<std::uint64_t>(dm) << (16 * i);
+        }
+    }
+
+    CSV_TARGET_AVX2
+    void classifyAVX2(const char *block, char delim, std::uint64_t &quotes, std::uint64_t &delims)
+    {
+        const __m256i q = _mm256_set1_epi8('"');
+        const __m256i d = _mm256_set1_epi8(delim);
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+
+        quotes = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, q)))
+          | static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, q)))) << 32;
+        delims = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, d)))
+          | static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, d)))) << 32;
+    }
+
+    bool hasAVX2(void)
+    {
+# ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+          return false;
+        __cpuid(info, 1);
+        // the OS must save the YMM registers (OSXSAVE + XCR0 bits 1 and 2)
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+          return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+# else
+        return __builtin_cpu_supports("avx2");
+# endif
+    }
+#endif
+
+    ClassifyFn selectClassify(void)
+    {
+#ifdef CSV_SSE2
+        if (hasAVX2())
+          return classifyAVX2;
+        return classifySSE2;
+#else
+        return classifyScalar;
+#endif
+    }
+
+    const ClassifyFn classify = selectClassify();
+
+    // bit i of the result is the XOR of bits 0..i of x
+    inline std::uint64_t prefixXor(std::uint64_t x)
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    inline unsigned int trailingZeros(std::uint64_t x)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long pos;
+        _BitScanForward64(&pos, x);
+        return pos;
+#elif defined(_MSC_VER)
+        unsigned long pos;
+        if (_BitScanForward(&pos, static_cast<unsigned long>(x)))
+          return pos;
+        _BitScanForward(&pos, static_cast<unsigned long>(x >> 32));
+        return pos + 32;
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    class Scanner
+    {
+      public:
+        Scanner(const char *data, std::size_t size, char delim, bool quoted = false)
+          : _data(data), _size(size), _delim(delim), _block(0), _bits(0),
+            _inside(quoted ? ~static_cast<std::uint64_t>(0) : 0)
+        {
+            load();
+        }
+
+        // offset of the next delimiter outside quotes, false at the end
+        bool next(std::size_t &pos)
+        {
+            while (_bits == 0)
+            {
+                _block += 64;
+                if (_block >= _size)
+                  return false;
+                load();
+            }
+            pos = _block + trailingZeros(_bits);
+            _bits &= _bits - 1;
+            return true;
+        }
+
+        // once next() has returned false: whether the data ends inside quotes
+        bool quoted(void) const
+        {
+            return _inside != 0;
+        }
+
+      private:
+        void load(void)
+        {
+            std::uint64_t quotes;
+            std::uint64_t delims;
+
+            if (_size - _block >= 64)
+              classify(_data + _block, _delim, quotes, delims);
+            else
+            {
+              // short tail: pad with zeroes, which are never structural
+              char tail[64] = { 0 };
+              std::memcpy(tail, _data + _block, _size - _block);
+              classify(tail, _delim, quotes, delims);
+              delims &= (static_cast<std::uint64_t>(1) << (_size - _block)) - 1;
+            }
+
+            std::uint64_t inside = prefixXor(quotes) ^ _inside;
+            // carry the quote state into the next block
+            _inside = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+            _bits = delims & ~inside;
+        }
+
+        const char *_data;
+        std::size_t _size;
+        const char _delim;
+        std::size_t _block;
+        std::uint64_t _bits;
+        std::uint64_t _inside;
+    };
+
+    // splits a line into row, honouring the projection; returns the
+    // number of columns the line really has
+    unsigned int splitFields(std::string_view line, char sep, const Projection &projection, RowView &row)
+    {
+        Scanner scanner(line.data(), line.size(), sep);
+        std::size_t tokenStart = 0;
+        std::size_t i;
+
+        row.clear();
+        if (projection.empty())
+        {
+          while (scanner.next(i))
+          {
+              row.push(line.substr(tokenStart, i - tokenStart));
+              tokenStart = i + 1;
+          }
+          row.push(line.substr(tokenStart));
+          return row.size();
+        }
+
+        unsigned int column = 0;
+        int slot;
+
+        row.resize(projection.size());
+        while (scanner.next(i))
+        {
+            if ((slot = projection.slot(column++)) >= 0)
+              row.set(slot, line.substr(tokenStart, i - tokenStart));
+            tokenStart = i + 1;
+        }
+        if ((slot = projection.slot(column++)) >= 0)
+          row.set(slot, line.substr(tokenStart));
+        return column;
+    }
+
+    std::string_view trim(std::string_view value)
+    {
+        const char *blanks = " \t\r\n";
+        std::size_t first = value.find_first_not_of(blanks);
+
+        if (first == std::string_view::npos)
+          return std::string_view();
+        return value.substr(first, value.find_last_not_of(blanks) - first + 1);
+    }
+
+    // strips blanks and one pair of surrounding quotes
+    std::string_view unwrap(std::string_view value)
+    {
+        value = trim(value);
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+          value = trim(value.substr(1, value.size() - 2));
+        return value;
+    }
+
+    template<typename T>
+    bool fromChars(std::string_view field, T &value)
+    {
+        std::string_view text = unwrap(field);
+
+        // from_chars does not take a leading plus sign
+        if (text.size() > 1 && text.front() == '+' && text[1] != '-')
+          text.remove_prefix(1);
+
+        const char *last = text.data() + text.size();
+        std::from_chars_result result = std::from_chars(text.data(), last, value);
+        return text.size() > 0 && result.ec == std::errc() && result.ptr == last;
+    }
+
+    // runs work(0) .. work(count - 1), each on its own thread
+    void parallelFor(unsigned int count, const std::function<void(unsigned int)> &work)
+    {
+        std::vector<std::thread> pool;
+
+        for (unsigned int i = 1; i < count; i++)
+          pool.push_back(std::thread(work, i));
+        if (count > 0)
+          work(0);
+        for (unsigned int i = 0; i < pool.size(); i++)
+          pool[i].join();
+    }
+  }
+
   Parser::Parser(const std::string &data, const DataType &type, char sep)
     : _type(type), _sep(sep)
   {
@@ -61,6 +358,9 @@ namespace csv {
 
       while (std::getline(ss, item, _sep))
           _header.push_back(item);
+
+      // one schema for the whole file, every row points at it
+      _schema = std::make_shared<const Schema>(_header);
   }
 
   void Parser::parseContent(void)
@@ -72,21 +372,16 @@ namespace csv {
 
      for (; it != _originalFile.end(); it++)
      {
-         bool quoted = false;
-         int tokenStart = 0;
-         unsigned int i = 0;
+         Scanner scanner(it->data(), it->length(), _sep);
+         std::size_t tokenStart = 0;
+         std::size_t i;
 
-         Row *row = new Row(_header);
+         Row *row = new Row(_schema);
 
-         for (; i != it->length(); i++)
+         while (scanner.next(i))
          {
-              if (it->at(i) == '"')
-                  quoted = ((quoted) ? (false) : (true));
-              else if (it->at(i) == ',' && !quoted)
-              {
-                  row->push(it->substr(tokenStart, i - tokenStart));
-                  tokenStart = i + 1;
-              }
+              row->push(it->substr(tokenStart, i - tokenStart));
+              tokenStart = i + 1;
          }
 
          //end
@@ -146,7 +441,7 @@ namespace csv {
 
   bool Parser::addRow(unsigned int pos, const std::vector<std::string> &r)
   {
-    Row *row = new Row(_header);
+    Row *row = new Row(_schema);
 
     for (auto it = r.begin(); it != r.end(); it++)
       row->push(*it);
@@ -189,12 +484,46 @@ namespace csv {
       return _file;    
   }
   
+  /*
+  ** SCHEMA
+  */
+
+  Schema::Schema(const std::vector<std::string> &names)
+      : _names(names)
+  {
+      // emplace keeps the first of duplicated names, like the old scan did
+      for (unsigned int i = 0; i < _names.size(); i++)
+        _index.emplace(_names[i], i);
+  }
+
+  unsigned int Schema::size(void) const
+  {
+    return _names.size();
+  }
+
+  const std::vector<std::string> &Schema::names(void) const
+  {
+    return _names;
+  }
+
+  int Schema::find(const std::string &name) const
+  {
+    std::unordered_map<std::string, unsigned int>::const_iterator it = _index.find(name);
+
+    if (it == _index.end())
+      return -1;
+    return it->second;
+  }
+
   /*
   ** ROW
   */
 
   Row::Row(const std::vector<std::string> &header)
-      : _header(header) {}
+      : _schema(std::make_shared<const Schema>(header)) {}
+
+  Row::Row(const std::shared_ptr<const Schema> &schema)
+      : _schema(schema) {}
 
   Row::~Row(void) {}
 
@@ -210,19 +539,12 @@ namespace csv {
 
   bool Row::set(const std::string &key, const std::string &value) 
   {
-    std::vector<std::string>::const_iterator it;
-    int pos = 0;
+    int pos = _schema->find(key);
 
-    for (it = _header.begin(); it != _header.end(); it++)
-    {
-        if (key == *it)
-        {
-          _values[pos] = value;
-          return true;
-        }
-        pos++;
-    }
-    return false;
+    if (pos < 0 || static_cast<unsigned int>(pos) >= _values.size())
+      return false;
+    _values[pos] = value;
+    return true;
   }
 
   const std::string Row::operator[](unsigned int valuePosition) const
@@ -234,16 +556,10 @@ namespace csv {
 
   const std::string Row::operator[](const std::string &key) const
   {
-      std::vector<std::string>::const_iterator it;
-      int pos = 0;
+      int pos = _schema->find(key);
 
-      for (it = _header.begin(); it != _header.end(); it++)
-      {
-          if (key == *it)
-              return _values[pos];
-          pos++;
-      }
-      
+      if (pos >= 0 && static_cast<unsigned int>(pos) < _values.size())
+          return _values[pos];
       throw Error("can't return this value (doesn't exist)");
   }
 
@@ -265,4 +581,635 @@ namespace csv {
     }
     return os;
   }
+
+  /*
+  ** DECODERS
+  */
+
+  bool parseCents(std::string_view field, std::int64_t &cents)
+  {
+      std::string_view value = unwrap(field);
+      const std::int64_t limit = (std::numeric_limits<std::int64_t>::max() / 100 - 9) / 10;
+      bool negative = false;
+      std::size_t i = 0;
+
+      // sign may come before or after the currency symbol
+      if (i < value.size() && (value[i] == '-' || value[i] == '+'))
+        negative = (value[i++] == '-');
+      if (i < value.size() && value[i] == '$')
+        i++;
+      if (i < value.size() && value[i] == '-' && !negative)
+      {
+        negative = true;
+        i++;
+      }
+
+      std::int64_t whole = 0;
+      unsigned int digits = 0;
+      for (; i < value.size(); i++)
+      {
+          if (value[i] >= '0' && value[i] <= '9')
+          {
+              if (whole > limit)
+                return false;
+              whole = whole * 10 + (value[i] - '0');
+              digits++;
+          }
+          // thousands separator, which must sit between digits
+          else if (value[i] != ',' || digits == 0 || i + 1 == value.size()
+                   || value[i + 1] < '0' || value[i + 1] > '9')
+              break;
+      }
+
+      std::int64_t fraction = 0;
+      unsigned int places = 0;
+      int round = 0;
+      if (i < value.size() && value[i] == '.')
+      {
+          for (i++; i < value.size() && value[i] >= '0' && value[i] <= '9'; i++)
+          {
+              if (places < 2)
+                fraction = fraction * 10 + (value[i] - '0');
+              else if (places == 2 && value[i] >= '5')
+                round = 1;
+              places++;
+          }
+      }
+
+      if (i != value.size() || (digits == 0 && places == 0))
+        return false;
+      if (places == 1)
+        fraction *= 10;
+
+      cents = whole * 100 + fraction + round;
+      if (negative)
+        cents = -cents;
+      return true;
+  }
+
+  bool parseInteger(std::string_view field, long long &value)
+  {
+      return fromChars(field, value);
+  }
+
+  bool parseInteger(std::string_view field, unsigned long long &value)
+  {
+      return fromChars(field, value);
+  }
+
+  bool parseDouble(std::string_view field, double &value)
+  {
+      return fromChars(field, value);
+  }
+
+  /*
+  ** MAPPED FILE
+  */
+
+#ifdef _WIN32
+  MappedFile::MappedFile(const std::string &path)
+    : _data(nullptr), _size(0), _file(INVALID_HANDLE_VALUE), _mapping(nullptr)
+  {
+      _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (_file == INVALID_HANDLE_VALUE)
+        throw Error(std::string("Failed to open ").append(path));
+
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+      {
+        CloseHandle(_file);
+        throw Error(std::string("No Data in ").append(path));
+      }
+      _size = static_cast<std::size_t>(size.QuadPart);
+
+      _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (_mapping != nullptr)
+        _data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+      if (_data == nullptr)
+      {
+        if (_mapping != nullptr)
+          CloseHandle(_mapping);
+        CloseHandle(_file);
+        throw Error(std::string("Failed to map ").append(path));
+      }
+  }
+
+  MappedFile::~MappedFile(void)
+  {
+      UnmapViewOfFile(_data);
+      CloseHandle(_mapping);
+      CloseHandle(_file);
+  }
+#else
+  MappedFile::MappedFile(const std::string &path)
+    : _data(nullptr), _size(0)
+  {
+      int fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw Error(std::string("Failed to open ").append(path));
+
+      struct stat st;
+      if (fstat(fd, &st) != 0 || st.st_size == 0)
+      {
+        close(fd);
+        throw Error(std::string("No Data in ").append(path));
+      }
+      _size = static_cast<std::size_t>(st.st_size);
+
+      void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd); // the mapping keeps its own reference to the file
+      if (addr == MAP_FAILED)
+        throw Error(std::string("Failed to map ").append(path));
+      madvise(addr, _size, MADV_SEQUENTIAL);
+      _data = static_cast<const char *>(addr);
+  }
+
+  MappedFile::~MappedFile(void)
+  {
+      munmap(const_cast<char *>(_data), _size);
+  }
+#endif
+
+  const char *MappedFile::data(void) const
+  {
+      return _data;
+  }
+
+  std::size_t MappedFile::size(void) const
+  {
+      return _size;
+  }
+
+  /*
+  ** MAPPED PARSER
+  */
+
+  MappedParser::MappedParser(const std::string &file, char sep, unsigned int threads)
+    : _file(file), _sep(sep), _map(file)
+  {
+      indexRows(threads);
+      if (_rows.size() == 0)
+        throw Error(std::string("No Data in ").append(_file));
+
+      // first line is the header, the rest is content
+      splitRow(_rows.front(), _header);
+      _rows.erase(_rows.begin());
+  }
+
+  MappedParser::~MappedParser(void) {}
+
+  void MappedParser::indexRows(unsigned int threads)
+  {
+      const char *data = _map.data();
+      std::size_t size = _map.size();
+
+      // below 1 MiB per range the threads cost more than they save
+      const std::size_t minChunk = 1 << 20;
+      unsigned int chunks = std::max(1u, std::min<unsigned int>(threads, size / minChunk));
+      std::vector<std::size_t> bounds(chunks + 1);
+      for (unsigned int c = 0; c <= chunks; c++)
+        bounds[c] = size / chunks * c;
+      bounds[chunks] = size;
+
+      // pre-pass: an odd number of quotes before a range means it starts
+      // in the middle of a quoted field
+      std::vector<std::size_t> quotes(chunks, 0);
+      if (chunks > 1)
+        parallelFor(chunks, [&](unsigned int c) {
+            quotes[c] = std::count(data + bounds[c], data + bounds[c + 1], '"');
+        });
+      std::vector<bool> quoted(chunks, false);
+      for (unsigned int c = 1; c < chunks; c++)
+        quoted[c] = (quoted[c - 1] != (quotes[c - 1] % 2 == 1));
+
+      // a newline only ends a row when it is outside quotes
+      std::vector<std::vector<std::size_t> > ends(chunks);
+      parallelFor(chunks, [&](unsigned int c) {
+          Scanner scanner(data + bounds[c], bounds[c + 1] - bounds[c], '\n', quoted[c]);
+          std::size_t i;
+
+          while (scanner.next(i))
+            ends[c].push_back(bounds[c] + i);
+      });
+
+      // stitch the ranges back together in file order
+      std::size_t lineStart = 0;
+      for (unsigned int c = 0; c < chunks; c++)
+      {
+          for (unsigned int k = 0; k < ends[c].size(); k++)
+          {
+              std::size_t end = ends[c][k];
+              if (end > lineStart && data[end - 1] == '\r')
+                  end--;
+              if (end > lineStart)
+                  _rows.push_back(std::string_view(data + lineStart, end - lineStart));
+              lineStart = ends[c][k] + 1;
+          }
+          std::vector<std::size_t>().swap(ends[c]);
+      }
+
+      // last line without a trailing newline
+      std::size_t end = size;
+      if (end > lineStart && data[end - 1] == '\r')
+          end--;
+      if (end > lineStart)
+          _rows.push_back(std::string_view(data + lineStart, end - lineStart));
+  }
+
+  unsigned int MappedParser::splitRow(std::string_view line, RowView &row) const
+  {
+      return splitFields(line, _sep, _projection, row);
+  }
+
+  void MappedParser::getRow(unsigned int rowPosition, RowView &row) const
+  {
+      if (rowPosition >= _rows.size())
+        throw Error("can't return this row (doesn't exist)");
+
+      // if value(s) missing
+      if (splitRow(_rows[rowPosition], row) != _header.size())
+        throw Error("corrupted data !");
+  }
+
+  void MappedParser::runBatches(unsigned int threads, const BatchWork &work, const BatchDone &done) const
+  {
+      unsigned int rows = _rows.size();
+      unsigned int batches = batchCount();
+
+      if (threads <= 1 || batches <= 1)
+      {
+        for (unsigned int b = 0; b < batches; b++)
+        {
+          work(b, b * BATCH_ROWS, std::min(rows, (b + 1) * BATCH_ROWS));
+          done(b);
+        }
+        return;
+      }
+
+      // workers run at most `window` batches ahead of the consumer
+      const unsigned int window = threads * 4;
+      std::mutex lock;
+      std::condition_variable changed;
+      std::vector<bool> ready(batches, false);
+      unsigned int nextBatch = 0;
+      unsigned int consumed = 0;
+      std::exception_ptr error;
+
+      auto fail = [&](void) {
+          std::lock_guard<std::mutex> guard(lock);
+          if (!error)
+            error = std::current_exception();
+          changed.notify_all();
+      };
+
+      auto worker = [&](void) {
+          while (true)
+          {
+              unsigned int b;
+              {
+                  std::unique_lock<std::mutex> guard(lock);
+                  changed.wait(guard, [&] {
+                      return error || nextBatch >= batches || nextBatch < consumed + window;
+                  });
+                  if (error || nextBatch >= batches)
+                    return;
+                  b = nextBatch++;
+              }
+              try
+              {
+                  work(b, b * BATCH_ROWS, std::min(rows, (b + 1) * BATCH_ROWS));
+              }
+              catch (...)
+              {
+                  fail();
+                  return;
+              }
+              std::lock_guard<std::mutex> guard(lock);
+              ready[b] = true;
+              changed.notify_all();
+          }
+      };
+
+      std::vector<std::thread> pool;
+      for (unsigned int t = 0; t < threads; t++)
+        pool.push_back(std::thread(worker));
+
+      // hand the batches over in file order
+      for (unsigned int b = 0; b < batches; b++)
+      {
+          {
+              std::unique_lock<std::mutex> guard(lock);
+              changed.wait(guard, [&] { return error || ready[b]; });
+              if (error)
+                break;
+          }
+          try
+          {
+              done(b);
+          }
+          catch (...)
+          {
+              fail();
+              break;
+          }
+          std::lock_guard<std::mutex> guard(lock);
+          consumed = b + 1;
+          changed.notify_all();
+      }
+
+      for (unsigned int t = 0; t < pool.size(); t++)
+        pool[t].join();
+      if (error)
+        std::rethrow_exception(error);
+  }
+
+  RowView MappedParser::getRow(unsigned int rowPosition) const
+  {
+      RowView row;
+
+      getRow(rowPosition, row);
+      return row;
+  }
+
+  RowView MappedParser::operator[](unsigned int rowPosition) const
+  {
+      return MappedParser::getRow(rowPosition);
+  }
+
+  unsigned int MappedParser::rowCount(void) const
+  {
+      return _rows.size();
+  }
+
+  unsigned int MappedParser::batchCount(void) const
+  {
+      return (_rows.size() + BATCH_ROWS - 1) / BATCH_ROWS;
+  }
+
+  unsigned int MappedParser::columnCount(void) const
+  {
+      return _header.size();
+  }
+
+  std::vector<std::string> MappedParser::getHeader(void) const
+  {
+      std::vector<std::string> header;
+
+      for (unsigned int i = 0; i < _header.size(); i++)
+        header.push_back(std::string(_header[i]));
+      return header;
+  }
+
+  const std::string MappedParser::getHeaderElement(unsigned int pos) const
+  {
+      if (pos >= _header.size())
+        throw Error("can't return this header (doesn't exist)");
+      return std::string(_header[pos]);
+  }
+
+  const std::string &MappedParser::getFileName(void) const
+  {
+      return _file;
+  }
+
+  void MappedParser::project(const std::vector<unsigned int> &columns)
+  {
+      _projection.select(columns, _header.size());
+  }
+
+  void MappedParser::projectNames(const std::vector<std::string> &names)
+  {
+      _projection.select(names, getHeader());
+  }
+
+  /*
+  ** READER
+  */
+
+  Reader::Reader(const std::string &file, char sep, std::size_t bufferSize)
+    : _file(file), _sep(sep), _stream(file.c_str(), std::ios::in | std::ios::binary),
+      _buffer(bufferSize > 0 ? bufferSize : 1), _begin(0), _end(0), _scanned(0), _quoted(false)
+  {
+      if (!_stream.is_open())
+        throw Error(std::string("Failed to open ").append(_file));
+
+      std::string_view line;
+      if (!readLine(line))
+        throw Error(std::string("No Data in ").append(_file));
+
+      RowView header;
+      splitRow(line, header);
+      for (unsigned int i = 0; i < header.size(); i++)
+        _header.push_back(std::string(header[i]));
+  }
+
+  Reader::~Reader(void) {}
+
+  bool Reader::fill(void)
+  {
+      if (!_stream.good())
+        return false;
+
+      // keep the unread part, growing the buffer if one row fills all of it
+      if (_begin > 0)
+      {
+        std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+        _end -= _begin;
+        _begin = 0;
+      }
+      if (_end == _buffer.size())
+        _buffer.resize(_buffer.size() * 2);
+
+      _stream.read(_buffer.data() + _end, _buffer.size() - _end);
+      std::size_t count = static_cast<std::size_t>(_stream.gcount());
+      _end += count;
+      return count > 0;
+  }
+
+  bool Reader::readLine(std::string_view &line)
+  {
+      while (true)
+      {
+          // rows always start outside quotes; when a row runs past the
+          // buffer, the part already scanned and its quote state are kept
+          // so the search resumes there after the refill
+          const char *data = _buffer.data() + _begin;
+          std::size_t size = _end - _begin;
+          std::size_t i;
+          Scanner scanner(data + _scanned, size - _scanned, '\n', _quoted);
+          bool complete = scanner.next(i);
+
+          if (!complete)
+          {
+              _scanned = size;
+              _quoted = scanner.quoted();
+              // the row runs past the buffer, read more unless at the end
+              if (fill())
+                continue;
+              if (size == 0)
+                return false;
+              i = size; // last line without a trailing newline
+          }
+          else
+              i += _scanned;
+          _begin += complete ? i + 1 : size;
+          _scanned = 0;
+          _quoted = false;
+
+          std::size_t end = i;
+          if (end > 0 && data[end - 1] == '\r')
+              end--;
+          if (end > 0)
+          {
+              line = std::string_view(data, end);
+              return true;
+          }
+          // empty line, skip it
+      }
+  }
+
+  unsigned int Reader::splitRow(std::string_view line, RowView &row) const
+  {
+      return splitFields(line, _sep, _projection, row);
+  }
+
+  bool Reader::readRow(RowView &row)
+  {
+      std::string_view line;
+
+      if (!readLine(line))
+        return false;
+
+      // if value(s) missing
+      if (splitRow(line, row) != _header.size())
+        throw Error("corrupted data !");
+      return true;
+  }
+
+  unsigned int Reader::columnCount(void) const
+  {
+      return _header.size();
+  }
+
+  std::vector<std::string> Reader::getHeader(void) const
+  {
+      return _header;
+  }
+
+  const std::string &Reader::getFileName(void) const
+  {
+      return _file;
+  }
+
+  void Reader::project(const std::vector<unsigned int> &columns)
+  {
+      _projection.select(columns, _header.size());
+  }
+
+  void Reader::projectNames(const std::vector<std::string> &names)
+  {
+      _projection.select(names, _header);
+  }
+
+  /*
+  ** PROJECTION
+  */
+
+  Projection::Projection(void)
+    : _size(0) {}
+
+  void Projection::select(const std::vector<unsigned int> &columns, unsigned int columnCount)
+  {
+      std::vector<int> slots(columnCount, -1);
+
+      for (unsigned int i = 0; i < columns.size(); i++)
+      {
+          if (columns[i] >= columnCount || slots[columns[i]] >= 0)
+            throw Error("can't project this column (doesn't exist)");
+          slots[columns[i]] = i;
+      }
+      _slots.swap(slots);
+      _size = columns.size();
+  }
+
+  void Projection::select(const std::vector<std::string> &names, const std::vector<std::string> &header)
+  {
+      std::vector<unsigned int> columns;
+
+      // header names are matched without their surrounding blanks
+      for (unsigned int i = 0; i < names.size(); i++)
+      {
+          unsigned int pos = 0;
+          while (pos < header.size() && trim(header[pos]) != trim(names[i]))
+            pos++;
+          if (pos == header.size())
+            throw Error(std::string("can't project this column (doesn't exist) : ").append(names[i]));
+          columns.push_back(pos);
+      }
+      select(columns, header.size());
+  }
+
+  bool Projection::empty(void) const
+  {
+      return _size == 0;
+  }
+
+  unsigned int Projection::size(void) const
+  {
+      return _size;
+  }
+
+  int Projection::slot(unsigned int column) const
+  {
+      if (column < _slots.size())
+        return _slots[column];
+      return -1;
+  }
+
+  /*
+  ** ROW VIEW
+  */
+
+  RowView::RowView(void) {}
+
+  unsigned int RowView::size(void) const
+  {
+    return _values.size();
+  }
+
+  void RowView::clear(void)
+  {
+    _values.clear();
+  }
+
+  void RowView::resize(unsigned int size)
+  {
+    _values.resize(size);
+  }
+
+  void RowView::push(std::string_view value)
+  {
+    _values.push_back(value);
+  }
+
+  void RowView::set(unsigned int pos, std::string_view value)
+  {
+    _values[pos] = value;
+  }
+
+  std::string_view RowView::operator[](unsigned int valuePosition) const
+  {
+       if (valuePosition < _values.size())
+           return _values[valuePosition];
+       throw Error("can't return this value (doesn't exist)");
+  }
+
+  std::ostream &operator<<(std::ostream &os, const RowView &row)
+  {
+      for (unsigned int i = 0; i != row._values.size(); i++)
+          os << row._values[i] << " | ";
+
+      return os;
+  }
 }
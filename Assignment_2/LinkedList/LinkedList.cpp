@@ -7,9 +7,21 @@
 //============================================================================
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
 #include <time.h>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "Bid.hpp"
+#include "BidSnapshot.hpp"
 #include "CSVparser.hpp"
 
 using namespace std;
@@ -18,24 +30,161 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
-// forward declarations
-double strToDouble(string str, char ch);
+/**
+ * Slab allocator for fixed size nodes.
+ *
+ * Nodes are carved out of large slabs with a bump pointer, so nodes
+ * allocated one after another sit next to each other in memory. Freed
+ * nodes go on a free list and are handed out again first. Destroying
+ * the pool releases every slab at once, which is why T must be
+ * trivially destructible.
+ */
+template <typename T>
+class NodePool {
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static constexpr size_t FIRST_SLAB = 256;
+    static constexpr size_t MAX_SLAB = 65536;
+
+    vector<Slot*> slabs;
+    Slot* freeList;     // nodes given back by Delete
+    Slot* cursor;       // next unused slot in the newest slab
+    Slot* limit;        // one past the end of the newest slab
+    size_t nextSlab;    // slots in the next slab to allocate
+
+    static_assert(is_trivially_destructible<T>::value,
+            "NodePool frees slabs without running destructors");
+
+    void grow() {
+        Slot* slab = static_cast<Slot*>(::operator new(nextSlab * sizeof(Slot)));
+        slabs.push_back(slab);
+        cursor = slab;
+        limit = slab + nextSlab;
+        nextSlab = min(nextSlab * 2, MAX_SLAB);
+    }
+
+public:
+    NodePool() {
+        freeList = nullptr;
+        cursor = nullptr;
+        limit = nullptr;
+        nextSlab = FIRST_SLAB;
+    }
+
+    ~NodePool() {
+        for (Slot* slab : slabs) {
+            ::operator delete(slab);
+        }
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /**
+     * Construct a node in the pool
+     *
+     * @param args Passed on to the constructor of T
+     * @return The new node
+     */
+    template <typename... Args>
+    T* New(Args&&... args) {
+        Slot* slot;
+
+        // reuse a freed node before taking a fresh one
+        if (freeList != nullptr) {
+            slot = freeList;
+            freeList = freeList->next;
+        } else {
+            if (cursor == limit) {
+                grow();
+            }
+            slot = cursor++;
+        }
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Give a node back to the pool
+     *
+     * @param node A node returned by New
+     */
+    void Delete(T* node) {
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    /**
+     * Take over every slab of another pool, so the nodes it handed out
+     * can move to a list that allocates from this one. The other pool
+     * is left empty.
+     *
+     * @param other The pool to take the slabs from
+     */
+    void Adopt(NodePool& other) {
+        slabs.insert(slabs.end(), other.slabs.begin(), other.slabs.end());
+
+        // chain its free nodes in front of ours
+        if (other.freeList != nullptr) {
+            Slot* last = other.freeList;
+            while (last->next != nullptr) {
+                last = last->next;
+            }
+            last->next = freeList;
+            freeList = other.freeList;
+        }
 
-// define a structure to hold bid information
-struct Bid {
-    string bidId; // unique identifier
-    string title;
-    string fund;
-    double amount;
-    Bid() {
-        amount = 0.0;
+        other.slabs.clear();
+        other.freeList = nullptr;
+        other.cursor = nullptr;
+        other.limit = nullptr;
     }
 };
 
+//============================================================================
+// Bid comparators
+//============================================================================
+
+// returns true when the first bid sorts before the second
+typedef bool (*BidCompare)(const Bid&, const Bid&);
+
+bool lessByAmount(const Bid& a, const Bid& b) {
+    return a.cents < b.cents;
+}
+
+bool lessByTitle(const Bid& a, const Bid& b) {
+    return a.Title() < b.Title();
+}
+
+bool lessByBidId(const Bid& a, const Bid& b) {
+    return a.bidId < b.bidId;
+}
+
+bool lessByFund(const Bid& a, const Bid& b) {
+    return a.Fund() < b.Fund();
+}
+
 //============================================================================
 // Linked-List class definition
 //============================================================================
 
+/**
+ * What a LinkedList does with a node that Search walked to:
+ * leave it in place, move it to the head, swap it with the node before
+ * it, or keep the list ordered by how often each node was found.
+ */
+enum SearchPolicy {
+    KEEP_ORDER,
+    MOVE_TO_FRONT,
+    TRANSPOSE,
+    COUNT_ORDER
+};
+
 /**
  * Define a class containing data members and methods to
  * implement a linked-list.
@@ -47,60 +196,92 @@ private:
     struct Node {
         Bid bid;
         Node *next;
+        unsigned int hits; // times Search found this node, for COUNT_ORDER
 
         // default constructor
         Node() {
             next = nullptr;
+            hits = 0;
         }
 
         // initialize with a bid
         Node(Bid aBid) {
             bid = aBid;
             next = nullptr;
+            hits = 0;
+        }
+    };
+
+    // Index entry for the first node holding a bid id. It points at the
+    // node before that one (nullptr for the head) so Remove can unlink
+    // without a walk.
+    struct IndexEntry {
+        Node *prev;
+        unsigned int copies; // nodes in the list with this id
+
+        IndexEntry(Node* aPrev) {
+            prev = aPrev;
+            copies = 1;
         }
     };
 
+    NodePool<Node> pool;
     Node* head;
     Node* tail;
     int size = 0;
+    bool indexed;
+    unordered_map<uint32_t, IndexEntry> index;
+    SearchPolicy policy;
+    unsigned long long searches;    // Search calls that walked the list
+    unsigned long long depth;       // nodes visited by those calls
+
+    void indexAppend(Node* node, Node* prev);
+    void indexPrepend(Node* node);
+    void removeIndexed(uint32_t bidId);
+    void reorganize(Node* node, Node* prev, Node* prevPrev);
+    void rebuildIndex();
+    static Node* split(Node* chain, int count);
+    static Node* merge(Node* left, Node* right, BidCompare less, Node** link);
 
 public:
-    LinkedList();
+    LinkedList(bool useIndex = false);
     virtual ~LinkedList();
     void Append(Bid bid);
     void Prepend(Bid bid);
     void PrintList();
-    void Remove(string bidId);
-    Bid Search(string bidId);
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
     int Size();
+    void SetSearchPolicy(SearchPolicy aPolicy);
+    double AverageSearchDepth();
+    void Sort(BidCompare less);
+    void Merge(LinkedList& other, BidCompare less);
 };
 
 /**
  * Default constructor
+ *
+ * @param useIndex keep an index from bid id to node, so Search and
+ *        Remove take constant time instead of walking the list
  */
-LinkedList::LinkedList() {
+LinkedList::LinkedList(bool useIndex) {
     // FIXME (1): Initialize housekeeping variables
     //set head and tail equal to nullptr
     head = nullptr;
     tail = nullptr;
 
     size = 0;
+    indexed = useIndex;
+    policy = KEEP_ORDER;
+    searches = 0;
+    depth = 0;
 }
 
 /**
  * Destructor
  */
 LinkedList::~LinkedList() {
-    // start at the head
-    Node* current = head;
-    Node* temp;
-
-    // loop over each node, detach from list then delete
-    while (current != nullptr) {
-        temp = current; // hang on to current node
-        current = current->next; // make current the next node
-        delete temp; // delete the orphan node
-    }
+    // every node lives in the pool, which frees them all at once
 }
 
 /**
@@ -109,7 +290,10 @@ LinkedList::~LinkedList() {
 void LinkedList::Append(Bid bid) {
     // FIXME (2): Implement append logic
     //Create new node
-    Node* newNode = new Node(bid);
+    Node* newNode = pool.New(bid);
+    if (indexed) {
+        indexAppend(newNode, tail);
+    }
     //if there is nothing at the head...
     if (head == nullptr) {
         // new node becomes the head and the tail
@@ -134,15 +318,22 @@ void LinkedList::Append(Bid bid) {
 void LinkedList::Prepend(Bid bid) {
     // FIXME (3): Implement prepend logic
     // Create new node
-    Node* newNode = new Node(bid);
+    Node* newNode = pool.New(bid);
     // if there is already something at the head...
     if (head != nullptr) {
         // new node points to current head as its next node
         newNode->next = head;
     }
+    // otherwise it is the tail as well
+    else {
+        tail = newNode;
+    }
 
     // head now becomes the new node
     head = newNode;
+    if (indexed) {
+        indexPrepend(newNode);
+    }
     
     //increase size count
     size++;
@@ -158,7 +349,7 @@ void LinkedList::PrintList() {
     // while loop over each node looking for a match
     while (currNode != nullptr) {
         //output current bidID, title, amount and fund
-        cout << currNode->bid.bidId << " | " << currNode->bid.title << " | " << currNode->bid.amount << " | " << currNode->bid.fund << endl;
+        cout << currNode->bid.bidId << " | " << currNode->bid.Title() << " | " << currNode->bid.Amount() << " | " << currNode->bid.Fund() << endl;
 
         //set current equal to next
         currNode = currNode->next;
@@ -170,7 +361,12 @@ void LinkedList::PrintList() {
  *
  * @param bidId The bid id to remove from the list
  */
-void LinkedList::Remove(string bidId) {
+void LinkedList::Remove(uint32_t bidId) {
+    if (indexed) {
+        removeIndexed(bidId);
+        return;
+    }
+
     // FIXME (5): Implement remove logic
     // special case if matching node is the head
     if (head == nullptr) {
@@ -183,10 +379,8 @@ void LinkedList::Remove(string bidId) {
         head = head->next;
         if (head == nullptr){
             tail = nullptr;
-            delete temp;
-            size--;
-            return;
         }
+        pool.Delete(temp);
         //decrease size count
         size--;
         //return
@@ -197,7 +391,7 @@ void LinkedList::Remove(string bidId) {
     Node* temp = nullptr;
 
     // while loop over each node looking for a match
-    while (currNode != nullptr) {
+    while (currNode->next != nullptr) {
         // if the next node bidID is equal to the current bidID
         if (currNode->next->bid.bidId == bidId) {
             // hold onto the next node temporarily
@@ -205,8 +399,12 @@ void LinkedList::Remove(string bidId) {
 
             // make current node point beyond the next node
             currNode->next = currNode->next->next;
-            // now free up memory held by temp
-            delete temp;
+            // the slot is reused, so the tail must not keep pointing at it
+            if (temp == tail) {
+                tail = currNode;
+            }
+            // now give the node back to the pool
+            pool.Delete(temp);
 
             // decrease size count
             size--;
@@ -226,7 +424,15 @@ void LinkedList::Remove(string bidId) {
  *
  * @param bidId The bid id to search for
  */
-Bid LinkedList::Search(string bidId) {
+Bid LinkedList::Search(uint32_t bidId) {
+    if (indexed) {
+        unordered_map<uint32_t, IndexEntry>::const_iterator it = index.find(bidId);
+        if (it == index.end()) {
+            return Bid();
+        }
+        return it->second.prev == nullptr ? head->bid : it->second.prev->next->bid;
+    }
+
     // FIXME (6): Implement search logic
 
     // special case if matching bid is the head
@@ -236,15 +442,23 @@ Bid LinkedList::Search(string bidId) {
 
     // start at the head of the list
     Node* currNode = head; 
+    Node* prev = nullptr;
+    Node* prevPrev = nullptr;
+    searches++;
 
     // keep searching until end reached with while loop (current != nullptr)
     while (currNode != nullptr) {
+        depth++;
         // if the current node matches, return current bid
         if (currNode->bid.bidId == bidId) {
-            return currNode->bid;
+            Bid found = currNode->bid;
+            reorganize(currNode, prev, prevPrev);
+            return found;
         }
         // else current node is equal to next node
         else {
+            prevPrev = prev;
+            prev = currNode;
             currNode = currNode->next;
         }
     }
@@ -263,183 +477,1501 @@ int LinkedList::Size() {
     return size;
 }
 
-//============================================================================
-// Static methods used for testing
-//============================================================================
+/**
+ * Sort the list with a bottom-up merge sort. Nodes are relinked, never
+ * copied or allocated, and bids that compare equal keep their order.
+ *
+ * @param less The order to sort in, e.g. lessByAmount
+ */
+void LinkedList::Sort(BidCompare less) {
+    if (size < 2) {
+        return;
+    }
+
+    // merge runs of width 1, 2, 4, ... until one run is the whole list
+    for (int width = 1; width < size; width *= 2) {
+        Node* rest = head;
+        Node** link = &head;
+        Node* last = nullptr;
+
+        while (rest != nullptr) {
+            Node* left = rest;
+            Node* right = split(left, width);
+            rest = split(right, width);
+            last = merge(left, right, less, link);
+            link = &last->next;
+        }
+        tail = last;
+    }
+
+    if (indexed) {
+        rebuildIndex();
+    }
+}
 
 /**
- * Display the bid information
+ * Merge another sorted list into this sorted one. The nodes of the other
+ * list are spliced in without copying a bid, leaving it empty.
  *
- * @param bid struct containing the bid info
+ * @param other A list sorted by the same order
+ * @param less The order both lists are sorted in
  */
-void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount
-         << " | " << bid.fund << endl;
-    return;
+void LinkedList::Merge(LinkedList& other, BidCompare less) {
+    if (&other == this || other.head == nullptr) {
+        return;
+    }
+
+    // the nodes now belong to this list, so does the memory they are in
+    pool.Adopt(other.pool);
+
+    tail = merge(head, other.head, less, &head);
+    size += other.size;
+
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.size = 0;
+    other.index.clear();
+
+    if (indexed) {
+        rebuildIndex();
+    }
 }
 
 /**
- * Prompt user for bid information
+ * Cut a chain after its first count nodes
  *
- * @return Bid struct containing the bid info
+ * @param chain The first node of the chain, may be nullptr
+ * @param count Number of nodes to keep
+ * @return The first node after the cut, nullptr if there is none
  */
-Bid getBid() {
-    Bid bid;
+LinkedList::Node* LinkedList::split(Node* chain, int count) {
+    for (int i = 1; chain != nullptr && i < count; i++) {
+        chain = chain->next;
+    }
+    if (chain == nullptr) {
+        return nullptr;
+    }
 
-    cout << "Enter Id: ";
-    cin.ignore();
-    getline(cin, bid.bidId);
+    Node* rest = chain->next;
+    chain->next = nullptr;
+    return rest;
+}
 
-    cout << "Enter title: ";
-    getline(cin, bid.title);
+/**
+ * Merge two sorted chains, taking from left when bids compare equal
+ *
+ * @param left First sorted chain
+ * @param right Second sorted chain
+ * @param less The order both chains are sorted in
+ * @param link Where to hang the merged chain
+ * @return The last node of the merged chain
+ */
+LinkedList::Node* LinkedList::merge(Node* left, Node* right, BidCompare less, Node** link) {
+    Node* last = nullptr;
+
+    while (left != nullptr && right != nullptr) {
+        if (less(right->bid, left->bid)) {
+            last = right;
+            right = right->next;
+        } else {
+            last = left;
+            left = left->next;
+        }
+        *link = last;
+        link = &last->next;
+    }
 
-    cout << "Enter fund: ";
-    cin >> bid.fund;
+    // one chain is used up, the rest of the other follows as it is
+    *link = left != nullptr ? left : right;
+    while (*link != nullptr) {
+        last = *link;
+        link = &last->next;
+    }
+    return last;
+}
 
-    cout << "Enter amount: ";
-    cin.ignore();
-    string strAmount;
-    getline(cin, strAmount);
-    bid.amount = strToDouble(strAmount, '$');
+/**
+ * Choose how Search reorders the list. Has no effect on a list with an
+ * index, whose Search does not walk the list.
+ *
+ * @param aPolicy The policy to use from now on
+ */
+void LinkedList::SetSearchPolicy(SearchPolicy aPolicy) {
+    policy = aPolicy;
+}
 
-    return bid;
+/**
+ * Returns the average number of nodes Search visited per call
+ */
+double LinkedList::AverageSearchDepth() {
+    return searches == 0 ? 0.0 : static_cast<double>(depth) / searches;
 }
 
 /**
- * Load a CSV file containing bids into a LinkedList
+ * Move a node Search found according to the search policy
  *
- * @return a LinkedList containing all the bids read
+ * @param node The node that was found
+ * @param prev The node before it, nullptr if it is the head
+ * @param prevPrev The node before prev, nullptr if there is none
  */
-void loadBids(string csvPath, LinkedList *list) {
-    cout << "Loading CSV file " << csvPath << endl;
+void LinkedList::reorganize(Node* node, Node* prev, Node* prevPrev) {
+    node->hits++;
 
-    // initialize the CSV Parser
-    csv::Parser file = csv::Parser(csvPath);
+    // the head is already where every policy wants it
+    if (prev == nullptr) {
+        return;
+    }
 
-    try {
-        // loop to read rows of a CSV file
-        for (int i = 0; i < file.rowCount(); i++) {
+    switch (policy) {
+    case KEEP_ORDER:
+        return;
 
-            // initialize a bid using data from current row (i)
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+    case MOVE_TO_FRONT:
+        prev->next = node->next;
+        node->next = head;
+        head = node;
+        break;
 
-            //cout << bid.bidId << ": " << bid.title << " | " << bid.fund << " | " << bid.amount << endl;
+    case TRANSPOSE:
+        if (prevPrev == nullptr) {
+            head = node;
+        } else {
+            prevPrev->next = node;
+        }
+        prev->next = node->next;
+        node->next = prev;
+        break;
 
-            // add this bid to the end
-            list->Append(bid);
+    case COUNT_ORDER: {
+        if (prev->hits >= node->hits) {
+            return;
         }
-    } catch (csv::Error &e) {
-        std::cerr << e.what() << std::endl;
+        prev->next = node->next;
+
+        // move in front of the first node found less often; prev is one,
+        // so the walk stops before reaching node's old place
+        Node* before = nullptr;
+        Node* after = head;
+        while (after->hits >= node->hits) {
+            before = after;
+            after = after->next;
+        }
+        node->next = after;
+        if (before == nullptr) {
+            head = node;
+        } else {
+            before->next = node;
+        }
+        break;
+    }
+    }
+
+    // node moved towards the head, so prev may be the last node now
+    if (tail == node) {
+        tail = prev;
     }
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
- *
- * credit: http://stackoverflow.com/a/24875936
- *
- * @param ch The character to strip out
+ * Index every node again after the list was reordered
  */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+void LinkedList::rebuildIndex() {
+    index.clear();
+
+    Node* prev = nullptr;
+    for (Node* node = head; node != nullptr; node = node->next) {
+        indexAppend(node, prev);
+        prev = node;
+    }
 }
 
 /**
- * The one and only main() method
+ * Index a node just added to the end of the list
  *
- * @param arg[1] path to CSV file to load from (optional)
- * @param arg[2] the bid Id to use when searching the list (optional)
+ * @param node The new node
+ * @param prev The node before it, nullptr if it is the head
  */
-int main(int argc, char* argv[]) {
+void LinkedList::indexAppend(Node* node, Node* prev) {
+    // an id already in the list keeps pointing at its first copy
+    pair<unordered_map<uint32_t, IndexEntry>::iterator, bool> result =
+            index.emplace(node->bid.bidId, IndexEntry(prev));
+    if (!result.second) {
+        result.first->second.copies++;
+    }
+}
 
-    // process command line arguments
-    string csvPath, bidKey;
-    switch (argc) {
-    case 2:
-        csvPath = argv[1];
-        bidKey = "98109";
-        break;
-    case 3:
-        csvPath = argv[1];
-        bidKey = argv[2];
-        break;
-    default:
-        csvPath = "eBid_Monthly_Sales.csv";
-        bidKey = "98109";
+/**
+ * Index a node just added to the start of the list
+ *
+ * @param node The new head
+ */
+void LinkedList::indexPrepend(Node* node) {
+    // the old head was the first copy of its id and now follows node
+    if (node->next != nullptr) {
+        index.find(node->next->bid.bidId)->second.prev = node;
     }
 
-    clock_t ticks;
+    // node is the first copy of its id now
+    pair<unordered_map<uint32_t, IndexEntry>::iterator, bool> result =
+            index.emplace(node->bid.bidId, IndexEntry(nullptr));
+    if (!result.second) {
+        result.first->second.prev = nullptr;
+        result.first->second.copies++;
+    }
+}
 
-    LinkedList bidList;
+/**
+ * Remove the first bid with an id, using the index to find it
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void LinkedList::removeIndexed(uint32_t bidId) {
+    unordered_map<uint32_t, IndexEntry>::iterator it = index.find(bidId);
+    if (it == index.end()) {
+        return;
+    }
 
-    Bid bid;
+    Node* prev = it->second.prev;
+    Node* node = prev == nullptr ? head : prev->next;
+    Node* next = node->next;
 
-    int choice = 0;
-    while (choice != 9) {
-        cout << "Menu:" << endl;
-        cout << "  1. Enter a Bid" << endl;
-        cout << "  2. Load Bids" << endl;
-        cout << "  3. Display All Bids" << endl;
-        cout << "  4. Find Bid" << endl;
-        cout << "  5. Remove Bid" << endl;
-        cout << "  9. Exit" << endl;
-        cout << "Enter choice: ";
-        cin >> choice;
+    // unlink the node
+    if (prev == nullptr) {
+        head = next;
+    } else {
+        prev->next = next;
+    }
+    if (tail == node) {
+        tail = prev;
+    }
 
-        switch (choice) {
-        case 1:
-            bid = getBid();
-            bidList.Append(bid);
-            displayBid(bid);
+    // the node after it now follows prev
+    if (next != nullptr) {
+        IndexEntry& nextEntry = index.find(next->bid.bidId)->second;
+        if (nextEntry.prev == node) {
+            nextEntry.prev = prev;
+        }
+    }
 
-            break;
+    if (--it->second.copies == 0) {
+        index.erase(it);
+    } else {
+        // the next copy of the id becomes the one Search finds
+        Node* before = prev;
+        Node* current = next;
+        while (current->bid.bidId != bidId) {
+            before = current;
+            current = current->next;
+        }
+        it->second.prev = before;
+    }
 
-        case 2:
-            ticks = clock();
+    pool.Delete(node);
+    size--;
+}
 
-            loadBids(csvPath, &bidList);
+//============================================================================
+// Unrolled-List class definition
+//============================================================================
 
-            cout << bidList.Size() << " bids read" << endl;
+/**
+ * A linked list that keeps up to BLOCK_BIDS bids in each node, so most
+ * steps of a scan read the next bid from the same block instead of
+ * following a pointer. Bids keep the order they were added in, exactly
+ * as in LinkedList.
+ */
+class UnrolledList {
 
-            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
-            cout << "time: " << ticks << " milliseconds" << endl;
-            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+private:
+    // 16 bids of 24 bytes fill six cache lines
+    static const int BLOCK_BIDS = 16;
 
-            break;
+    struct Block {
+        Bid bids[BLOCK_BIDS];
+        int count;
+        Block *next;
 
-        case 3:
-            bidList.PrintList();
+        // default constructor
+        Block() {
+            count = 0;
+            next = nullptr;
+        }
+    };
 
-            break;
+    NodePool<Block> pool;
+    Block* head;
+    Block* tail;
+    int size;
 
-        case 4:
-            ticks = clock();
+public:
+    UnrolledList();
+    virtual ~UnrolledList();
+    void Append(Bid bid);
+    void Prepend(Bid bid);
+    void PrintList();
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
+    int Size();
+};
 
-            bid = bidList.Search(bidKey);
+/**
+ * Default constructor
+ */
+UnrolledList::UnrolledList() {
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+}
 
-            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+/**
+ * Destructor
+ */
+UnrolledList::~UnrolledList() {
+    // every block lives in the pool, which frees them all at once
+}
 
-            if (!bid.bidId.empty()) {
-                displayBid(bid);
-            } else {
-            	cout << "Bid Id " << bidKey << " not found." << endl;
-            }
+/**
+ * Append a new bid to the end of the list
+ */
+void UnrolledList::Append(Bid bid) {
+    // start a new block when the last one is full
+    if (tail == nullptr || tail->count == BLOCK_BIDS) {
+        Block* block = pool.New();
+        if (head == nullptr) {
+            head = block;
+        } else {
+            tail->next = block;
+        }
+        tail = block;
+    }
 
-            cout << "time: " << ticks << " clock ticks" << endl;
-            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+    tail->bids[tail->count++] = bid;
+    size++;
+}
 
-            break;
+/**
+ * Prepend a new bid to the start of the list
+ */
+void UnrolledList::Prepend(Bid bid) {
+    // start a new block when the first one is full
+    if (head == nullptr || head->count == BLOCK_BIDS) {
+        Block* block = pool.New();
+        block->next = head;
+        head = block;
+        if (tail == nullptr) {
+            tail = block;
+        }
+    }
 
-        case 5:
-            bidList.Remove(bidKey);
+    // shift the block up by one to make room at the front
+    memmove(&head->bids[1], &head->bids[0], head->count * sizeof(Bid));
+    head->bids[0] = bid;
+    head->count++;
+    size++;
+}
 
-            break;
+/**
+ * Simple output of all bids in the list
+ */
+void UnrolledList::PrintList() {
+    for (Block* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; i++) {
+            const Bid& bid = block->bids[i];
+            cout << bid.bidId << " | " << bid.Title() << " | " << bid.Amount() << " | " << bid.Fund() << endl;
+        }
+    }
+}
+
+/**
+ * Remove a specified bid
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void UnrolledList::Remove(uint32_t bidId) {
+    Block* prev = nullptr;
+
+    for (Block* block = head; block != nullptr; prev = block, block = block->next) {
+        for (int i = 0; i < block->count; i++) {
+            if (block->bids[i].bidId != bidId) {
+                continue;
+            }
+
+            // close the gap inside the block
+            memmove(&block->bids[i], &block->bids[i + 1], (block->count - i - 1) * sizeof(Bid));
+            block->count--;
+            size--;
+
+            // pull the next block in when both fit in one, so blocks
+            // never drift towards holding a single bid each
+            Block* next = block->next;
+            if (next != nullptr && block->count + next->count <= BLOCK_BIDS) {
+                memcpy(&block->bids[block->count], &next->bids[0], next->count * sizeof(Bid));
+                block->count += next->count;
+                block->next = next->next;
+                if (tail == next) {
+                    tail = block;
+                }
+                pool.Delete(next);
+            }
+
+            // unlink a block that is now empty
+            if (block->count == 0) {
+                if (prev == nullptr) {
+                    head = block->next;
+                } else {
+                    prev->next = block->next;
+                }
+                if (tail == block) {
+                    tail = prev;
+                }
+                pool.Delete(block);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid UnrolledList::Search(uint32_t bidId) {
+    for (Block* block = head; block != nullptr; block = block->next) {
+        for (int i = 0; i < block->count; i++) {
+            if (block->bids[i].bidId == bidId) {
+                return block->bids[i];
+            }
+        }
+    }
+    return Bid();
+}
+
+/**
+ * Returns the current size (number of elements) in the list
+ */
+int UnrolledList::Size() {
+    return size;
+}
+
+//============================================================================
+// Concurrent-List class definition
+//============================================================================
+
+/**
+ * A linked list that any number of threads can append to at once.
+ *
+ * An append swaps the new node into the tail with one atomic exchange
+ * and then links the old tail to it, so it never waits for another
+ * thread. A node becomes visible from the head once its predecessor has
+ * been linked to it, so Search and PrintList, which can run while appends
+ * are in flight, see the bids in append order up to some point.
+ *
+ * Remove must not run while other threads append or remove, but Search
+ * and PrintList may run alongside it. A removed node is never reused,
+ * since a reader may still be standing on it; it is freed with the rest
+ * when the list is destroyed.
+ *
+ * Each thread appends through its own Appender, which allocates from a
+ * pool of its own so it never waits on an allocator lock either. An
+ * Appender gathers its bids into a run that Publish links at the tail
+ * in one exchange, so threads that each build part of the list can
+ * publish the parts in the order the list should have. Append takes a
+ * lock to allocate and is meant for a single thread, or for the odd bid
+ * added by hand.
+ */
+class ConcurrentList {
+
+private:
+    struct Node {
+        Bid bid;
+        atomic<Node*> next;
+
+        // default constructor
+        Node() {
+            next.store(nullptr, memory_order_relaxed);
+        }
+
+        // initialize with a bid
+        Node(Bid aBid) {
+            bid = aBid;
+            next.store(nullptr, memory_order_relaxed);
+        }
+    };
+
+    Node head;              // placeholder, head.next is the first bid
+    atomic<Node*> tail;     // last node, &head when the list is empty
+    atomic<int> size;
+    NodePool<Node> pool;    // every node, removed ones included
+    mutex poolLock;
+
+    void link(Node* first, Node* last, int count);
+
+public:
+    /**
+     * A thread's handle for appending. Bids appended through it are kept
+     * in a run of its own until Publish puts them in the list; any still
+     * unpublished when it is destroyed are dropped. Nodes come from a
+     * pool of its own that is handed to the list when the Appender is
+     * destroyed, so it must not outlive the list.
+     */
+    class Appender {
+
+    private:
+        ConcurrentList& list;
+        NodePool<Node> pool;
+        Node* first;        // the run not yet published
+        Node* last;
+        int count;
+
+    public:
+        Appender(ConcurrentList& aList);
+        virtual ~Appender();
+        Appender(const Appender&) = delete;
+        Appender& operator=(const Appender&) = delete;
+        void Append(Bid bid);
+        void Publish();
+        template <typename Visit>
+        void ForEachPending(Visit visit) const;
+    };
+
+    ConcurrentList();
+    virtual ~ConcurrentList();
+    void Append(Bid bid);
+    void PrintList();
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
+    int Size();
+};
+
+/**
+ * Default constructor
+ */
+ConcurrentList::ConcurrentList() {
+    tail.store(&head, memory_order_relaxed);
+    size.store(0, memory_order_relaxed);
+}
+
+/**
+ * Destructor
+ */
+ConcurrentList::~ConcurrentList() {
+    // every node lives in the pool, which frees them all at once
+}
+
+/**
+ * Put a run of linked nodes at the end of the list, safe to call from
+ * any thread
+ */
+void ConcurrentList::link(Node* first, Node* last, int count) {
+    // claim the tail first, then hang the run off the old tail; the
+    // release store publishes the bids along with the pointer
+    Node* prev = tail.exchange(last, memory_order_acq_rel);
+    prev->next.store(first, memory_order_release);
+    size.fetch_add(count, memory_order_relaxed);
+}
+
+/**
+ * Append a new bid to the end of the list
+ */
+void ConcurrentList::Append(Bid bid) {
+    Node* node;
+    {
+        lock_guard<mutex> lock(poolLock);
+        node = pool.New(bid);
+    }
+    link(node, node, 1);
+}
+
+/**
+ * Simple output of all bids in the list
+ */
+void ConcurrentList::PrintList() {
+    for (Node* node = head.next.load(memory_order_acquire); node != nullptr;
+            node = node->next.load(memory_order_acquire)) {
+        cout << node->bid.bidId << " | " << node->bid.Title() << " | " << node->bid.Amount() << " | " << node->bid.Fund() << endl;
+    }
+}
+
+/**
+ * Remove a specified bid; no thread may append or remove meanwhile
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void ConcurrentList::Remove(uint32_t bidId) {
+    Node* prev = &head;
+    Node* node = head.next.load(memory_order_acquire);
+
+    while (node != nullptr) {
+        Node* next = node->next.load(memory_order_acquire);
+        if (node->bid.bidId == bidId) {
+            prev->next.store(next, memory_order_release);
+            if (tail.load(memory_order_relaxed) == node) {
+                tail.store(prev, memory_order_relaxed);
+            }
+            size.fetch_sub(1, memory_order_relaxed);
+
+            // the node stays in the pool, a reader may still be on it
+            return;
+        }
+        prev = node;
+        node = next;
+    }
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid ConcurrentList::Search(uint32_t bidId) {
+    for (Node* node = head.next.load(memory_order_acquire); node != nullptr;
+            node = node->next.load(memory_order_acquire)) {
+        if (node->bid.bidId == bidId) {
+            return node->bid;
+        }
+    }
+    return Bid();
+}
+
+/**
+ * Returns the number of bids appended and not removed
+ */
+int ConcurrentList::Size() {
+    return size.load(memory_order_relaxed);
+}
+
+/**
+ * Start appending to a list from the calling thread
+ */
+ConcurrentList::Appender::Appender(ConcurrentList& aList) : list(aList) {
+    first = nullptr;
+    last = nullptr;
+    count = 0;
+}
+
+/**
+ * Destructor, the list takes over the nodes this Appender allocated
+ */
+ConcurrentList::Appender::~Appender() {
+    lock_guard<mutex> lock(list.poolLock);
+    list.pool.Adopt(pool);
+}
+
+/**
+ * Add a new bid to the end of this Appender's run without taking any lock
+ */
+void ConcurrentList::Appender::Append(Bid bid) {
+    Node* node = pool.New(bid);
+
+    // nobody else sees the run yet, Publish makes the links visible
+    if (last == nullptr) {
+        first = node;
+    } else {
+        last->next.store(node, memory_order_relaxed);
+    }
+    last = node;
+    count++;
+}
+
+/**
+ * Put the run appended so far at the end of the list
+ */
+void ConcurrentList::Appender::Publish() {
+    if (first != nullptr) {
+        list.link(first, last, count);
+        first = nullptr;
+        last = nullptr;
+        count = 0;
+    }
+}
+
+/**
+ * Call visit with each bid of the run not yet published, in order
+ */
+template <typename Visit>
+void ConcurrentList::Appender::ForEachPending(Visit visit) const {
+    for (Node* node = first; node != nullptr; node = node->next.load(memory_order_relaxed)) {
+        visit(node->bid);
+    }
+}
+
+
+//============================================================================
+// Skip-List class definition
+//============================================================================
+
+/**
+ * A list kept in bidId order with express lanes above it. Every node is
+ * in the bottom lane; each lane above holds about a quarter of the nodes
+ * of the one below, picked at random, so Append, Search and Remove skip
+ * over most of the list and take O(log n) expected steps.
+ *
+ * Bids with the same id stay in the order they were appended, and
+ * Search and Remove act on the first of them, as in LinkedList.
+ */
+class SkipList {
+
+private:
+    // enough lanes for 4^16 bids
+    static const int MAX_LEVEL = 16;
+
+    // a node is allocated with room for exactly height next pointers,
+    // its tower, which sits right after it
+    struct Node {
+        Bid bid;
+        int height;
+
+        Node** tower() {
+            return reinterpret_cast<Node**>(this + 1);
+        }
+    };
+
+    static_assert(sizeof(Node) % alignof(Node*) == 0, "the tower follows a Node");
+
+    static const size_t SLAB_BYTES = 1 << 16;
+
+    vector<char*> slabs;
+    char* cursor;                   // next free byte in the newest slab
+    char* limit;                    // end of the newest slab
+    Node* freeNodes[MAX_LEVEL + 1]; // nodes given back, by height
+
+    Node* head;     // holds no bid, its tower is MAX_LEVEL high
+    int level;      // lanes in use
+    int size;
+    uint64_t seed;  // state of the random tower heights
+
+    Node* allocate(Bid bid, int height);
+    void release(Node* node);
+    int randomHeight();
+    Node* findFirst(uint32_t bidId, Node** update);
+
+public:
+    SkipList();
+    virtual ~SkipList();
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+    void Append(Bid bid);
+    void PrintList();
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
+    int Size();
+
+    /**
+     * Visit the bids with ids from low to high, inclusive, in id order
+     *
+     * @param low The smallest id to visit
+     * @param high The largest id to visit
+     * @param visit Called with each bid
+     */
+    template <typename Visit>
+    void ForEachInRange(uint32_t low, uint32_t high, Visit visit) {
+        for (Node* node = findFirst(low, nullptr); node != nullptr && node->bid.bidId <= high;
+                node = node->tower()[0]) {
+            visit(node->bid);
+        }
+    }
+};
+
+/**
+ * Default constructor
+ */
+SkipList::SkipList() {
+    cursor = nullptr;
+    limit = nullptr;
+    for (int i = 0; i <= MAX_LEVEL; i++) {
+        freeNodes[i] = nullptr;
+    }
+    head = allocate(Bid(), MAX_LEVEL);
+    level = 1;
+    size = 0;
+    seed = 0x9E3779B97F4A7C15ULL;
+}
+
+/**
+ * Destructor
+ */
+SkipList::~SkipList() {
+    for (char* slab : slabs) {
+        delete[] slab;
+    }
+}
+
+/**
+ * Carve a node with a tower of the given height out of the slabs
+ */
+SkipList::Node* SkipList::allocate(Bid bid, int height) {
+    Node* node = freeNodes[height];
+
+    if (node != nullptr) {
+        freeNodes[height] = node->tower()[0];
+    } else {
+        size_t bytes = sizeof(Node) + height * sizeof(Node*);
+        if (cursor == nullptr || static_cast<size_t>(limit - cursor) < bytes) {
+            cursor = new char[SLAB_BYTES];
+            limit = cursor + SLAB_BYTES;
+            slabs.push_back(cursor);
+        }
+        node = reinterpret_cast<Node*>(cursor);
+        cursor += bytes;
+    }
+
+    new (node) Node();
+    node->bid = bid;
+    node->height = height;
+    for (int i = 0; i < height; i++) {
+        node->tower()[i] = nullptr;
+    }
+    return node;
+}
+
+/**
+ * Give a node back for reuse by a later node of the same height
+ */
+void SkipList::release(Node* node) {
+    node->tower()[0] = freeNodes[node->height];
+    freeNodes[node->height] = node;
+}
+
+/**
+ * Pick a tower height: 1 for three nodes in four, then each further
+ * lane with one chance in four
+ */
+int SkipList::randomHeight() {
+    // xorshift64
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    uint64_t bits = seed;
+    int height = 1;
+    while (height < MAX_LEVEL && (bits & 3) == 0) {
+        height++;
+        bits >>= 2;
+    }
+    return height;
+}
+
+/**
+ * Find the first node with an id not less than bidId
+ *
+ * @param bidId The id to look for
+ * @param update If not nullptr, set to the last node before it in each lane
+ * @return The node, nullptr if every id is smaller
+ */
+SkipList::Node* SkipList::findFirst(uint32_t bidId, Node** update) {
+    Node* node = head;
+
+    // drop a lane each time the next node would overshoot
+    for (int i = level - 1; i >= 0; i--) {
+        while (node->tower()[i] != nullptr && node->tower()[i]->bid.bidId < bidId) {
+            node = node->tower()[i];
+        }
+        if (update != nullptr) {
+            update[i] = node;
+        }
+    }
+    return node->tower()[0];
+}
+
+/**
+ * Add a bid in id order, after any bids with the same id
+ */
+void SkipList::Append(Bid bid) {
+    Node* update[MAX_LEVEL];
+    Node* node = head;
+
+    for (int i = level - 1; i >= 0; i--) {
+        while (node->tower()[i] != nullptr && node->tower()[i]->bid.bidId <= bid.bidId) {
+            node = node->tower()[i];
+        }
+        update[i] = node;
+    }
+
+    int height = randomHeight();
+    for (; level < height; level++) {
+        update[level] = head;
+    }
+
+    Node* newNode = allocate(bid, height);
+    for (int i = 0; i < height; i++) {
+        newNode->tower()[i] = update[i]->tower()[i];
+        update[i]->tower()[i] = newNode;
+    }
+    size++;
+}
+
+/**
+ * Simple output of all bids in the list, in id order
+ */
+void SkipList::PrintList() {
+    for (Node* node = head->tower()[0]; node != nullptr; node = node->tower()[0]) {
+        cout << node->bid.bidId << " | " << node->bid.Title() << " | " << node->bid.Amount() << " | " << node->bid.Fund() << endl;
+    }
+}
+
+/**
+ * Remove a specified bid
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void SkipList::Remove(uint32_t bidId) {
+    Node* update[MAX_LEVEL];
+    Node* node = findFirst(bidId, update);
+
+    if (node == nullptr || node->bid.bidId != bidId) {
+        return;
+    }
+
+    // unlink from every lane it is in
+    for (int i = 0; i < node->height; i++) {
+        update[i]->tower()[i] = node->tower()[i];
+    }
+    while (level > 1 && head->tower()[level - 1] == nullptr) {
+        level--;
+    }
+
+    release(node);
+    size--;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid SkipList::Search(uint32_t bidId) {
+    Node* node = findFirst(bidId, nullptr);
+
+    if (node != nullptr && node->bid.bidId == bidId) {
+        return node->bid;
+    }
+    return Bid();
+}
+
+/**
+ * Returns the current size (number of elements) in the list
+ */
+int SkipList::Size() {
+    return size;
+}
+
+//============================================================================
+// Static methods used for testing
+//============================================================================
+
+/**
+ * Display the bid information
+ *
+ * @param bid struct containing the bid info
+ */
+void displayBid(Bid bid) {
+    cout << bid.bidId << ": " << bid.Title() << " | " << bid.Amount()
+         << " | " << bid.Fund() << endl;
+    return;
+}
+
+/**
+ * Prompt user for bid information
+ *
+ * @return Bid struct containing the bid info
+ */
+Bid getBid() {
+    string bidId, title, fund;
+
+    cout << "Enter Id: ";
+    cin.ignore();
+    getline(cin, bidId);
+
+    cout << "Enter title: ";
+    getline(cin, title);
+
+    cout << "Enter fund: ";
+    cin >> fund;
+
+    cout << "Enter amount: ";
+    cin.ignore();
+    string strAmount;
+    getline(cin, strAmount);
+    int64_t cents = 0;
+    csv::parseCents(strAmount, cents);
+
+    // auction ids are numeric, anything else leaves the bid empty
+    uint32_t id = 0;
+    if (!parseBidId(bidId, id)) {
+        cout << "Bid Id " << bidId << " is not a valid auction id." << endl;
+        return Bid();
+    }
+
+    return Bid(id, title, fund, cents);
+}
+
+/**
+ * Rebuild a bid from one entry of a compiled snapshot
+ *
+ * @param snapshot The mapped snapshot
+ * @param i Position of the bid in the snapshot
+ * @return Bid struct containing the bid info
+ */
+Bid snapshotBid(const BidSnapshot& snapshot, size_t i) {
+    return Bid(snapshot.BidId(i), snapshot.Title(i), snapshot.Fund(i), snapshot.Cents(i));
+}
+
+// only the four columns a bid is built from are split out, by position
+// since the monthly exports don't agree on the header names
+const vector<unsigned int> BID_COLUMNS = { 1, 0, 8, 4 };
+
+/**
+ * Parse the numbers of one CSV row projected to BID_COLUMNS; the strings
+ * still point into the row and are interned when a Bid is made
+ *
+ * @param row the projected row
+ * @return the parsed bid, with id 0 if the auction id is unusable
+ */
+ParsedBid parseBid(const csv::RowView &row) {
+    ParsedBid parsed;
+    parseBidId(row[0], parsed.bidId);
+    parsed.title = row[1];
+    parsed.fund = row[2];
+
+    // the amount is decoded as exact cents, "$1,125.00 " included
+    csv::parseCents(row[3], parsed.cents);
+
+    return parsed;
+}
+
+/**
+ * Parse the rows of a CSV file into bids, handing each one to store in
+ * file order. The file is mapped and parsed on every core; a file that
+ * can't be mapped, such as a pipe, is read through a fixed buffer on
+ * this thread instead.
+ *
+ * @param csvPath the path to the CSV file to read
+ * @param store called with each parsed bid
+ */
+template <typename Store>
+void readBids(const string& csvPath, Store store) {
+    // parse on every core, bids still arrive one at a time in file order
+    unsigned int threads = max(1u, thread::hardware_concurrency());
+
+    bool mapped = false;
+    try {
+        // map the CSV file and index its rows in parallel
+        csv::MappedParser file(csvPath, ',', threads);
+        mapped = true;
+        file.project(BID_COLUMNS);
+
+        file.forEachRow(parseBid, store, threads);
+        return;
+    } catch (csv::Error &e) {
+        if (mapped) {
+            throw;
+        }
+    }
+
+    // stream it instead; a missing file fails here too
+    csv::Reader file(csvPath);
+    file.project(BID_COLUMNS);
+
+    file.forEachRow([&](const csv::RowView &row) {
+        ParsedBid parsed = parseBid(row);
+        store(parsed);
+    });
+}
+
+/**
+ * Append the bids of a CSV file to a list one at a time as they are
+ * parsed, adding each to the snapshot being compiled
+ *
+ * @param csvPath the path to the CSV file to read
+ * @param list the list to append the bids to
+ * @param compiled the snapshot the bids are added to
+ * @param skipped counts the rows that have no usable auction id
+ */
+template <typename List>
+void appendRows(const string& csvPath, List* list, BidSnapshotWriter& compiled, unsigned int& skipped) {
+    // each bid arrives here, one at a time in file order
+    readBids(csvPath, [&](ParsedBid &parsed) {
+        // rows without a numeric auction id can't be stored
+        if (parsed.bidId == 0) {
+            skipped++;
+            return;
+        }
+
+        // initialize a bid using data from the current row
+        Bid bid(parsed.bidId, parsed.title, parsed.fund, parsed.cents);
+
+        // add this bid to the end
+        list->Append(bid);
+        compiled.Add(bid.bidId, bid.cents, parsed.title, parsed.fund);
+    });
+}
+
+/**
+ * Append the bids of a CSV file to a ConcurrentList from every core.
+ * Each batch of rows is parsed into a run of nodes by a worker thread
+ * through an Appender of its own, and the runs are published in file
+ * order, so the list comes out as it would from a single thread.
+ *
+ * @param csvPath the path to the CSV file to read
+ * @param list the list to append the bids to
+ * @param compiled the snapshot the bids are added to
+ * @param skipped counts the rows that have no usable auction id
+ */
+void appendRows(const string& csvPath, ConcurrentList* list, BidSnapshotWriter& compiled, unsigned int& skipped) {
+    unsigned int threads = max(1u, thread::hardware_concurrency());
+
+    bool mapped = false;
+    try {
+        csv::MappedParser file(csvPath, ',', threads);
+        mapped = true;
+        file.project(BID_COLUMNS);
+
+        // a run and a skip count for each batch, freed once it is published
+        vector<unique_ptr<ConcurrentList::Appender>> runs(file.batchCount());
+        vector<unsigned int> skippedIn(file.batchCount(), 0);
+
+        file.forEachBatch(
+            [&](unsigned int batch, unsigned int first, unsigned int last) {
+                runs[batch].reset(new ConcurrentList::Appender(*list));
+                csv::RowView row;
+
+                for (unsigned int i = first; i < last; i++) {
+                    file.getRow(i, row);
+                    ParsedBid parsed = parseBid(row);
+                    if (parsed.bidId == 0) {
+                        skippedIn[batch]++;
+                        continue;
+                    }
+                    runs[batch]->Append(Bid(parsed.bidId, parsed.title, parsed.fund, parsed.cents));
+                }
+            },
+            [&](unsigned int batch) {
+                // batches finish here one at a time, in file order
+                skipped += skippedIn[batch];
+                runs[batch]->ForEachPending([&](const Bid& bid) {
+                    compiled.Add(bid.bidId, bid.cents, bid.Title(), bid.Fund());
+                });
+                runs[batch]->Publish();
+                runs[batch].reset();
+            },
+            threads);
+        return;
+    } catch (csv::Error &e) {
+        if (mapped) {
+            throw;
+        }
+    }
+
+    // a file that can't be mapped is streamed on this thread
+    appendRows<ConcurrentList>(csvPath, list, compiled, skipped);
+}
+
+/**
+ * Load a CSV file containing bids into a list
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param list the list to append the bids to
+ */
+template <typename List>
+void loadBids(string csvPath, List *list) {
+    // a current snapshot compiled from this CSV skips parsing altogether
+    string snapshotPath = csvPath + ".snap";
+    try {
+        BidSnapshot snapshot(snapshotPath, csvPath);
+
+        cout << "Loading snapshot " << snapshotPath << endl;
+        for (size_t i = 0; i < snapshot.Size(); i++) {
+            list->Append(snapshotBid(snapshot, i));
+        }
+        return;
+    } catch (SnapshotError &e) {
+        // missing or out of date, read the CSV instead
+    }
+
+    cout << "Loading CSV file " << csvPath << endl;
+
+    // the bids read are compiled into a snapshot for the next load
+    BidSnapshotWriter compiled;
+    unsigned int skipped = 0;
+
+    try {
+        appendRows(csvPath, list, compiled, skipped);
+        compiled.Write(snapshotPath, csvPath);
+    } catch (SnapshotError &e) {
+        std::cerr << e.what() << std::endl;
+    } catch (csv::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+
+    // reported even when a damaged file stopped the load part way
+    if (skipped > 0) {
+        cout << skipped << " rows skipped, auction id is missing or not a 32-bit number" << endl;
+    }
+}
+
+/**
+ * Sorting is only offered by LinkedList
+ *
+ * @return false, the list was left as it is
+ */
+template <typename List>
+bool sortBids(List*) {
+    cout << "Only a LinkedList can be sorted." << endl;
+    return false;
+}
+
+/**
+ * Sort a list by winning bid, lowest first
+ *
+ * @param list the list to sort
+ * @return true
+ */
+bool sortBids(LinkedList* list) {
+    list->Sort(lessByAmount);
+    return true;
+}
+
+/**
+ * Only a LinkedList can be loaded in order
+ */
+template <typename List>
+void loadSortedBids(string, List* list) {
+    sortBids(list);
+}
+
+/**
+ * Load a CSV file into a list and leave it all sorted by winning bid.
+ * The new bids are loaded into a list of their own and sorted there,
+ * then merged into the sorted list in one pass, so the bids already in
+ * the list are not sorted over again with them.
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param list the list to merge the bids into
+ */
+void loadSortedBids(string csvPath, LinkedList* list) {
+    LinkedList loaded;
+    loadBids(csvPath, &loaded);
+    loaded.Sort(lessByAmount);
+
+    list->Sort(lessByAmount);
+    list->Merge(loaded, lessByAmount);
+}
+
+/**
+ * Range queries are only offered by SkipList, the list kept in id order
+ */
+template <typename List>
+void displayRange(List*) {
+    cout << "Only a SkipList keeps bids in id order." << endl;
+}
+
+/**
+ * Prompt for a range of auction ids and display the bids in it, in id
+ * order
+ *
+ * @param list the list to search
+ */
+void displayRange(SkipList* list) {
+    string low, high;
+
+    cout << "Enter first Id: ";
+    cin.ignore();
+    getline(cin, low);
+
+    cout << "Enter last Id: ";
+    getline(cin, high);
+
+    uint32_t first = 0, last = 0;
+    if (!parseBidId(low, first) || !parseBidId(high, last)) {
+        cout << "Not a valid auction id." << endl;
+        return;
+    }
+
+    int count = 0;
+    list->ForEachInRange(first, last, [&count](const Bid& bid) {
+        displayBid(bid);
+        count++;
+    });
+    cout << count << " bids in range" << endl;
+}
+
+/**
+ * Run the interactive menu against one kind of list
+ *
+ * @param bidList the list to keep the bids in
+ * @param csvPath the CSV file to load bids from
+ * @param bidKey the bid Id to use when searching the list
+ */
+template <typename List>
+void runMenu(List& bidList, const string& csvPath, const string& bidKey) {
+    // auction ids are numeric, so the key is parsed once up front
+    uint32_t bidId = 0;
+    parseBidId(bidKey, bidId);
+
+    clock_t ticks;
+
+    Bid bid;
+
+    int choice = 0;
+    while (choice != 9) {
+        cout << "Menu:" << endl;
+        cout << "  1. Enter a Bid" << endl;
+        cout << "  2. Load Bids" << endl;
+        cout << "  3. Display All Bids" << endl;
+        cout << "  4. Find Bid" << endl;
+        cout << "  5. Remove Bid" << endl;
+        cout << "  6. Sort Bids by Amount" << endl;
+        cout << "  7. Load Bids Sorted by Amount" << endl;
+        cout << "  8. Display Bids in Id Range" << endl;
+        cout << "  9. Exit" << endl;
+        cout << "Enter choice: ";
+        cin >> choice;
+
+        switch (choice) {
+        case 1:
+            bid = getBid();
+            if (bid.bidId != 0) {
+                bidList.Append(bid);
+                displayBid(bid);
+            }
+
+            break;
+
+        case 2:
+            ticks = clock();
+
+            loadBids(csvPath, &bidList);
+
+            cout << bidList.Size() << " bids read" << endl;
+
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+            cout << "time: " << ticks << " milliseconds" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 3:
+            bidList.PrintList();
+
+            break;
+
+        case 4:
+            ticks = clock();
+
+            bid = bidList.Search(bidId);
+
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+            if (bid.bidId != 0) {
+                displayBid(bid);
+            } else {
+            	cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 5:
+            bidList.Remove(bidId);
+
+            break;
+
+        case 6:
+            ticks = clock();
+
+            if (sortBids(&bidList)) {
+                ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+                cout << bidList.Size() << " bids sorted" << endl;
+                cout << "time: " << ticks << " clock ticks" << endl;
+                cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            }
+
+            break;
+
+        case 7:
+            ticks = clock();
+
+            loadSortedBids(csvPath, &bidList);
+
+            cout << bidList.Size() << " bids read" << endl;
+
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 8:
+            displayRange(&bidList);
+
+            break;
+        }
+    }
+
+}
+
+/**
+ * The one and only main() method
+ *
+ * @param arg[1] path to CSV file to load from (optional)
+ * @param arg[2] the bid Id to use when searching the list (optional)
+ * @param arg[3] "unrolled" to keep the bids in an UnrolledList, or
+ *        "indexed" for a LinkedList with an id index, or "move-to-front",
+ *        "transpose" or "count" for a self-organizing LinkedList, or
+ *        "concurrent" for a ConcurrentList, or "skiplist" for a SkipList
+ *        kept in id order (optional)
+ */
+int main(int argc, char* argv[]) {
+
+    // process command line arguments
+    string csvPath, bidKey, listType;
+    switch (argc) {
+    case 2:
+        csvPath = argv[1];
+        bidKey = "98109";
+        break;
+    case 3:
+        csvPath = argv[1];
+        bidKey = argv[2];
+        break;
+    case 4:
+        csvPath = argv[1];
+        bidKey = argv[2];
+        listType = argv[3];
+        break;
+    default:
+        csvPath = "eBid_Monthly_Sales.csv";
+        bidKey = "98109";
+    }
+
+    if (listType == "unrolled") {
+        UnrolledList bidList;
+        runMenu(bidList, csvPath, bidKey);
+    } else if (listType == "concurrent") {
+        ConcurrentList bidList;
+        runMenu(bidList, csvPath, bidKey);
+    } else if (listType == "skiplist") {
+        SkipList bidList;
+        runMenu(bidList, csvPath, bidKey);
+    } else {
+        LinkedList bidList(listType == "indexed");
+        SearchPolicy policy = KEEP_ORDER;
+        if (listType == "move-to-front") {
+            policy = MOVE_TO_FRONT;
+        } else if (listType == "transpose") {
+            policy = TRANSPOSE;
+        } else if (listType == "count") {
+            policy = COUNT_ORDER;
+        }
+        bidList.SetSearchPolicy(policy);
+        runMenu(bidList, csvPath, bidKey);
+
+        // only worth reporting when Search reorganizes the list
+        if (policy != KEEP_ORDER) {
+            cout << "average search depth: " << bidList.AverageSearchDepth() << endl;
         }
     }
 
@@ -1,8 +1,18 @@
 #ifndef     _CSVPARSER_HPP_
 # define    _CSVPARSER_HPP_
 
+# include <cstddef>
+# include <cstdint>
+# include <fstream>
+# include <functional>
+# include <memory>
 # include <stdexcept>
 # include <string>
+# include <string_view>
+# include <limits>
+# include <type_traits>
+# include <unordered_map>
+# include <utility>
 # include <vector>
 # include <list>
 # include <sstream>
@@ -19,10 +29,46 @@ namespace csv
         }
     };
 
+    /*
+    ** Typed field decoders. They read straight from the field text, never
+    ** allocate, skip surrounding blanks and one pair of quotes, and return
+    ** false instead of guessing when the field is not a number.
+    **
+    ** parseCents reads money as an exact number of cents: "$3,000 ",
+    ** "\"$1,125.50 \"", "-$4.1" and "12" are all accepted, digits past
+    ** the cents are rounded half up. A comma is only taken as a thousands
+    ** separator between two digits, so "1,,2" and "1," are rejected.
+    */
+    bool parseCents(std::string_view, std::int64_t &);
+    bool parseInteger(std::string_view, long long &);
+    bool parseInteger(std::string_view, unsigned long long &);
+    bool parseDouble(std::string_view, double &);
+
+    /*
+    ** Column names of a file, built once and shared by every Row of it.
+    ** The name-to-position map makes a lookup by name cost one hash
+    ** instead of a scan over the header.
+    */
+    class Schema
+    {
+      public:
+        Schema(const std::vector<std::string> &);
+
+      public:
+        unsigned int size(void) const;
+        const std::vector<std::string> &names(void) const;
+        int find(const std::string &) const;
+
+      private:
+        const std::vector<std::string> _names;
+        std::unordered_map<std::string, unsigned int> _index;
+    };
+
     class Row
     {
     	public:
     	    Row(const std::vector<std::string> &);
+    	    Row(const std::shared_ptr<const Schema> &);
     	    ~Row(void);
 
     	public:
@@ -31,7 +77,7 @@ namespace csv
             bool set(const std::string &, const std::string &); 
 
     	private:
-    		const std::vector<std::string> _header;
+    		const std::shared_ptr<const Schema> _schema;
     		std::vector<std::string> _values;
 
         public:
@@ -41,10 +87,32 @@ namespace csv
             {
                 if (pos < _values.size())
                 {
-                    T res;
-                    std::stringstream ss;
-                    ss << _values[pos];
-                    ss >> res;
+                    T res = T();
+                    if constexpr (std::is_integral<T>::value && std::is_signed<T>::value)
+                    {
+                        long long value;
+                        if (parseInteger(_values[pos], value)
+                            && value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max())
+                          res = static_cast<T>(value);
+                    }
+                    else if constexpr (std::is_integral<T>::value)
+                    {
+                        unsigned long long value;
+                        if (parseInteger(_values[pos], value) && value <= std::numeric_limits<T>::max())
+                          res = static_cast<T>(value);
+                    }
+                    else if constexpr (std::is_floating_point<T>::value)
+                    {
+                        double value;
+                        if (parseDouble(_values[pos], value))
+                          res = static_cast<T>(value);
+                    }
+                    else
+                    {
+                        std::stringstream ss;
+                        ss << _values[pos];
+                        ss >> res;
+                    }
                     return res;
                 }
                 throw Error("can't return this value (doesn't exist)");
@@ -90,11 +158,236 @@ namespace csv
         const char _sep;
         std::vector<std::string> _originalFile;
         std::vector<std::string> _header;
+        std::shared_ptr<const Schema> _schema;
         std::vector<Row *> _content;
 
     public:
         Row &operator[](unsigned int row) const;
     };
+
+    /*
+    ** Read-only memory mapping of a whole file. The mapping lives as long
+    ** as the object, so views handed out from it must not outlive it.
+    */
+    class MappedFile
+    {
+      public:
+        MappedFile(const std::string &);
+        ~MappedFile(void);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+      public:
+        const char *data(void) const;
+        std::size_t size(void) const;
+
+      private:
+        const char *_data;
+        std::size_t _size;
+# ifdef _WIN32
+        void *_file;
+        void *_mapping;
+# endif
+    };
+
+    /*
+    ** A row whose fields are slices of the parser's buffer. Nothing is
+    ** copied, so the views are only valid while the parser is alive.
+    ** A RowView can be handed back to the parser to be refilled, which
+    ** keeps its field vector allocated across rows.
+    */
+    class RowView
+    {
+        public:
+            RowView(void);
+
+        public:
+            unsigned int size(void) const;
+            void clear(void);
+            void resize(unsigned int);
+            void push(std::string_view);
+            void set(unsigned int, std::string_view);
+
+            std::string_view operator[](unsigned int) const;
+            friend std::ostream& operator<<(std::ostream& os, const RowView &row);
+
+        private:
+            std::vector<std::string_view> _values;
+    };
+
+    /*
+    ** Column projection: which columns a row is split into, and at which
+    ** position each one lands in the RowView. Columns that are not selected
+    ** are only counted, never stored. An empty projection keeps every
+    ** column in file order.
+    */
+    class Projection
+    {
+      public:
+        Projection(void);
+
+      public:
+        void select(const std::vector<unsigned int> &columns, unsigned int columnCount);
+        void select(const std::vector<std::string> &names, const std::vector<std::string> &header);
+        bool empty(void) const;
+        unsigned int size(void) const;
+        int slot(unsigned int column) const;
+
+      private:
+        std::vector<int> _slots;
+        unsigned int _size;
+    };
+
+    /*
+    ** Zero-copy parser: the file is memory mapped and only the row
+    ** boundaries are indexed up front. Fields are split on access and
+    ** returned as std::string_view slices into the mapping, so loading
+    ** costs no allocation per field and peak memory stays close to the
+    ** file size.
+    **
+    ** With more than one thread the mapping is cut into byte ranges that
+    ** are indexed in parallel. A quote-counting pre-pass tells each range
+    ** whether it starts inside a quoted field, so a newline inside quotes
+    ** is never taken for a row break.
+    */
+    class MappedParser
+    {
+
+    public:
+        MappedParser(const std::string &, char sep = ',', unsigned int threads = 1);
+        ~MappedParser(void);
+
+    public:
+        RowView getRow(unsigned int row) const;
+        void getRow(unsigned int row, RowView &) const;
+        unsigned int rowCount(void) const;
+        unsigned int columnCount(void) const;
+        std::vector<std::string> getHeader(void) const;
+        const std::string getHeaderElement(unsigned int pos) const;
+        const std::string &getFileName(void) const;
+        void project(const std::vector<unsigned int> &columns);
+        void projectNames(const std::vector<std::string> &names);
+
+        /*
+        ** Converts every row on `threads` worker threads and hands the
+        ** results to `consume` on the calling thread, in file order.
+        ** `convert` must be safe to call concurrently; only a bounded
+        ** number of converted batches is held at any time.
+        */
+        template<typename Convert, typename Consume>
+        unsigned int forEachRow(Convert convert, Consume consume, unsigned int threads) const
+        {
+            typedef decltype(convert(std::declval<const RowView &>())) Value;
+            std::vector<std::vector<Value> > results(batchCount());
+
+            runBatches(threads,
+                [&](unsigned int batch, unsigned int first, unsigned int last) {
+                    RowView row;
+                    std::vector<Value> &out = results[batch];
+
+                    out.reserve(last - first);
+                    for (unsigned int i = first; i < last; i++)
+                    {
+                        getRow(i, row);
+                        out.push_back(convert(static_cast<const RowView &>(row)));
+                    }
+                },
+                [&](unsigned int batch) {
+                    for (unsigned int i = 0; i < results[batch].size(); i++)
+                        consume(results[batch][i]);
+                    std::vector<Value>().swap(results[batch]);
+                });
+            return _rows.size();
+        }
+
+        /*
+        ** The batches under forEachRow, for callers that keep their own
+        ** state per batch: `work(batch, first, last)` runs on a worker
+        ** thread for rows [first, last), and `done(batch)` on the calling
+        ** thread once that batch is worked, in file order.
+        */
+        template<typename Work, typename Done>
+        unsigned int forEachBatch(Work work, Done done, unsigned int threads) const
+        {
+            runBatches(threads, work, done);
+            return _rows.size();
+        }
+        unsigned int batchCount(void) const;
+
+    protected:
+        typedef std::function<void(unsigned int, unsigned int, unsigned int)> BatchWork;
+        typedef std::function<void(unsigned int)> BatchDone;
+
+        static const unsigned int BATCH_ROWS = 4096;
+
+        void indexRows(unsigned int threads);
+        unsigned int splitRow(std::string_view, RowView &) const;
+        void runBatches(unsigned int threads, const BatchWork &, const BatchDone &) const;
+
+    private:
+        std::string _file;
+        const char _sep;
+        MappedFile _map;
+        RowView _header;
+        std::vector<std::string_view> _rows;
+        Projection _projection;
+
+    public:
+        RowView operator[](unsigned int row) const;
+    };
+
+    /*
+    ** Streaming reader: the file is read through one fixed buffer and each
+    ** row is split into a caller-provided RowView, so memory stays flat no
+    ** matter how large the file is. The views in the row are only valid
+    ** until the next row is read.
+    */
+    class Reader
+    {
+
+    public:
+        Reader(const std::string &, char sep = ',', std::size_t bufferSize = 1 << 20);
+        ~Reader(void);
+
+    public:
+        bool readRow(RowView &);
+        unsigned int columnCount(void) const;
+        std::vector<std::string> getHeader(void) const;
+        const std::string &getFileName(void) const;
+        void project(const std::vector<unsigned int> &columns);
+        void projectNames(const std::vector<std::string> &names);
+
+        template<typename F>
+        unsigned int forEachRow(F callback)
+        {
+            RowView row;
+            unsigned int count = 0;
+
+            while (readRow(row))
+            {
+                callback(static_cast<const RowView &>(row));
+                count++;
+            }
+            return count;
+        }
+
+    protected:
+        bool readLine(std::string_view &);
+        bool fill(void);
+        unsigned int splitRow(std::string_view, RowView &) const;
+
+    private:
+        std::string _file;
+        const char _sep;
+        std::ifstream _stream;
+        std::vector<char> _buffer;
+        std::size_t _begin;
+        std::size_t _end;
+        std::size_t _scanned;   // bytes past _begin already searched for a newline
+        bool _quoted;           // whether those bytes end inside quotes
+        std::vector<std::string> _header;
+        Projection _projection;
+    };
 }
 
 #endif /*!_CSVPARSER_HPP_*/
@@ -0,0 +1,522 @@
+//============================================================================
+// Name        : FrozenTable.cpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Read-only bid table with a minimal perfect hash
+//============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include "BidSnapshot.hpp"
+#include "FrozenTable.hpp"
+#include "HashPolicy.hpp"
+
+using namespace std;
+
+namespace {
+
+const char FROZEN_MAGIC[8] = { 'E', 'B', 'I', 'D', 'M', 'P', 'H', 'F' };
+
+}
+
+/**
+ * Freeze a set of bids. When an id appears more than once the first
+ * one is kept, as HashTable::Search would find it.
+ *
+ * @param bids The bids to freeze
+ */
+FrozenTable::FrozenTable(const vector<Bid>& bids) {
+    build(bids);
+    point(image.data());
+}
+
+/**
+ * Map a saved frozen table and check it
+ *
+ * @param path The frozen table file
+ * @param sourcePath The CSV it should match; when that file still
+ *        exists, a table built from another version of it is rejected
+ */
+FrozenTable::FrozenTable(const string& path, const string& sourcePath) {
+    try {
+        file = new csv::MappedFile(path);
+    } catch (csv::Error& e) {
+        throw FrozenError(string("can't open ").append(path));
+    }
+
+    try {
+        validate(sourcePath);
+    } catch (FrozenError& e) {
+        delete file;
+        throw;
+    }
+    point(file->data());
+}
+
+/**
+ * Destructor
+ */
+FrozenTable::~FrozenTable() {
+    delete file;
+}
+
+/**
+ * Hash a bid id with one of many hash functions
+ */
+uint64_t FrozenTable::keyHash(uint32_t bidId, uint64_t seed) {
+    return hashBytes(&bidId, sizeof(bidId), seed);
+}
+
+/**
+ * Pick the bucket of a key from the top half of its hash. As in PTHash
+ * the buckets are skewed, 60% of the keys going to the first 30% of the
+ * buckets: the crowded buckets are placed while the table is empty and
+ * the rest are small enough to fit in what is left.
+ */
+size_t FrozenTable::bucketOf(uint64_t h, uint32_t buckets) {
+    const uint64_t SPLIT = 2576980378ULL;   // 0.6 * 2^32
+    uint64_t x = h >> 32;
+    uint64_t dense = buckets * uint64_t(3) / 10;
+
+    if (x < SPLIT) {
+        return static_cast<size_t>(x * dense / SPLIT);
+    }
+    return static_cast<size_t>(dense + (x - SPLIT) * (buckets - dense) / ((uint64_t(1) << 32) - SPLIT));
+}
+
+/**
+ * Checksum of a file image. The header is covered too, since a changed
+ * seed or count would quietly send searches to the wrong slots, but not
+ * the source stamp, which Save rewrites, nor the checksum itself.
+ */
+uint64_t FrozenTable::imageChecksum(const char* data, size_t size) {
+    FrozenHeader h;
+    memcpy(&h, data, sizeof(h));
+    h.sourceSize = 0;
+    h.sourceTime = 0;
+    h.checksum = 0;
+    return checksum(reinterpret_cast<const char*>(&h), sizeof(h))
+            ^ checksum(data + sizeof(h), size - sizeof(h));
+}
+
+/**
+ * Pick the position of a key once its bucket's pilot is known
+ */
+size_t FrozenTable::positionOf(uint64_t h, uint32_t pilot, uint32_t positions) {
+    uint64_t x = MixHash::Hash(pilot) ^ h;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(((x >> 32) * positions) >> 32);
+}
+
+/**
+ * Find a pilot for every bucket
+ *
+ * @param hashes The key hashes, all different
+ * @param pilots Set to the pilot of each bucket
+ * @return false if some bucket found no pilot, so another seed is needed
+ */
+bool FrozenTable::findPilots(const vector<uint64_t>& hashes, uint32_t buckets, uint32_t positions,
+        vector<uint32_t>& pilots) {
+    // sort the keys by bucket, and the buckets largest first
+    vector<uint32_t> starts(buckets + 1, 0);
+    for (uint64_t h : hashes) {
+        starts[bucketOf(h, buckets) + 1]++;
+    }
+    size_t largest = 0;
+    for (uint32_t b = 0; b < buckets; b++) {
+        largest = max<size_t>(largest, starts[b + 1]);
+        starts[b + 1] += starts[b];
+    }
+    vector<uint64_t> keys(hashes.size());
+    vector<uint32_t> next(starts.begin(), starts.end() - 1);
+    for (uint64_t h : hashes) {
+        keys[next[bucketOf(h, buckets)]++] = h;
+    }
+
+    vector<vector<uint32_t>> bySize(largest + 1);
+    for (uint32_t b = 0; b < buckets; b++) {
+        bySize[starts[b + 1] - starts[b]].push_back(b);
+    }
+
+    pilots.assign(buckets, 0);
+    vector<bool> taken(positions, false);
+    vector<size_t> placed;
+
+    for (size_t bucketSize = largest; bucketSize > 0; bucketSize--) {
+        for (uint32_t b : bySize[bucketSize]) {
+            for (uint32_t pilot = 0; ; pilot++) {
+                if (pilot == MAX_PILOT) {
+                    return false;
+                }
+
+                // take the positions one by one, giving them back on a clash
+                placed.clear();
+                for (uint32_t k = starts[b]; k < starts[b + 1]; k++) {
+                    size_t pos = positionOf(keys[k], pilot, positions);
+                    if (taken[pos]) {
+                        break;
+                    }
+                    taken[pos] = true;
+                    placed.push_back(pos);
+                }
+                if (placed.size() == bucketSize) {
+                    pilots[b] = pilot;
+                    break;
+                }
+                for (size_t pos : placed) {
+                    taken[pos] = false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Build the file image: hash the ids, then lay the bids out by slot
+ */
+void FrozenTable::build(const vector<Bid>& all) {
+    if (all.size() > numeric_limits<uint32_t>::max() / 2) {
+        throw FrozenError("too many bids");
+    }
+
+    // the first bid of each id: sorting id and position together puts
+    // the earliest of equal ids first
+    vector<uint64_t> order(all.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = (static_cast<uint64_t>(all[i].bidId) << 32) | i;
+    }
+    sort(order.begin(), order.end());
+    vector<Bid> bids;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i == 0 || (order[i] >> 32) != (order[i - 1] >> 32)) {
+            bids.push_back(all[order[i] & UINT32_MAX]);
+        }
+    }
+
+    uint32_t count = static_cast<uint32_t>(bids.size());
+    uint32_t buckets = max(1u, (count + AVERAGE_BUCKET - 1) / AVERAGE_BUCKET);
+    uint32_t positions = count == 0 ? 0 : static_cast<uint32_t>(count / LOAD) + 1;
+
+    // a seed where two ids hash alike, or a bucket finds no pilot, is
+    // replaced by the next one
+    uint64_t seed = 0;
+    vector<uint64_t> hashes(count);
+    vector<uint32_t> pilotList;
+    for (;; seed++) {
+        for (uint32_t i = 0; i < count; i++) {
+            hashes[i] = keyHash(bids[i].bidId, seed);
+        }
+        vector<uint64_t> sorted(hashes);
+        sort(sorted.begin(), sorted.end());
+        if (adjacent_find(sorted.begin(), sorted.end()) == sorted.end()
+                && findPilots(hashes, buckets, positions, pilotList)) {
+            break;
+        }
+    }
+
+    // positions past the last slot are sent to the free slots below it
+    vector<uint32_t> slotOfBid(count);
+    vector<bool> used(count, false);
+    vector<uint32_t> remapList(positions - count, 0);
+    for (uint32_t i = 0; i < count; i++) {
+        size_t pos = positionOf(hashes[i], pilotList[bucketOf(hashes[i], buckets)], positions);
+        slotOfBid[i] = static_cast<uint32_t>(pos);
+        if (pos < count) {
+            used[pos] = true;
+        }
+    }
+    uint32_t nextFree = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (slotOfBid[i] >= count) {
+            while (used[nextFree]) {
+                nextFree++;
+            }
+            used[nextFree] = true;
+            remapList[slotOfBid[i] - count] = nextFree;
+            slotOfBid[i] = nextFree;
+        }
+    }
+
+    // bids in slot order
+    vector<const Bid*> slots(count);
+    for (uint32_t i = 0; i < count; i++) {
+        slots[slotOfBid[i]] = &bids[i];
+    }
+
+    // the fund names used, numbered in order of first use
+    vector<int> localFund(fundDictionary().Size(), -1);
+    vector<FrozenRow> rowList(count);
+    string fundHeap;
+    vector<uint32_t> fundIndex(1, 0);
+    string titleHeap;
+    vector<uint32_t> titleIndex(1, 0);
+    for (uint32_t i = 0; i < count; i++) {
+        const Bid* bid = slots[i];
+        string_view title = bid->Title();
+        if (titleHeap.size() + title.size() > numeric_limits<uint32_t>::max()) {
+            throw FrozenError("titles are too long");
+        }
+        titleHeap.append(title.data(), title.size());
+        titleIndex.push_back(static_cast<uint32_t>(titleHeap.size()));
+
+        if (localFund[bid->fund] < 0) {
+            localFund[bid->fund] = static_cast<int>(fundIndex.size() - 1);
+            fundHeap.append(bid->Fund());
+            fundIndex.push_back(static_cast<uint32_t>(fundHeap.size()));
+        }
+
+        memset(&rowList[i], 0, sizeof(FrozenRow));
+        rowList[i].cents = bid->cents;
+        rowList[i].bidId = bid->bidId;
+        rowList[i].fund = static_cast<uint16_t>(localFund[bid->fund]);
+    }
+
+    FrozenHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, FROZEN_MAGIC, sizeof(h.magic));
+    h.version = FROZEN_VERSION;
+    h.count = count;
+    h.buckets = buckets;
+    h.positions = positions;
+    h.fundCount = static_cast<uint32_t>(fundIndex.size() - 1);
+    h.seed = seed;
+
+    // lay the sections out one after the other
+    h.pilotsOffset = align8(sizeof(h));
+    h.remapOffset = align8(h.pilotsOffset + buckets * sizeof(uint32_t));
+    h.rowsOffset = align8(h.remapOffset + remapList.size() * sizeof(uint32_t));
+    h.titleIndexOffset = align8(h.rowsOffset + count * sizeof(FrozenRow));
+    h.titleHeapOffset = align8(h.titleIndexOffset + titleIndex.size() * sizeof(uint32_t));
+    h.fundIndexOffset = align8(h.titleHeapOffset + titleHeap.size());
+    h.fundHeapOffset = align8(h.fundIndexOffset + fundIndex.size() * sizeof(uint32_t));
+    h.fileSize = h.fundHeapOffset + fundHeap.size();
+
+    // an empty column may have no data pointer at all
+    image.assign(h.fileSize, '\0');
+    auto put = [this](uint64_t offset, const void* data, size_t bytes) {
+        if (bytes != 0) {
+            memcpy(&image[offset], data, bytes);
+        }
+    };
+    put(h.pilotsOffset, pilotList.data(), buckets * sizeof(uint32_t));
+    put(h.remapOffset, remapList.data(), remapList.size() * sizeof(uint32_t));
+    put(h.rowsOffset, rowList.data(), rowList.size() * sizeof(FrozenRow));
+    put(h.titleIndexOffset, titleIndex.data(), titleIndex.size() * sizeof(uint32_t));
+    put(h.titleHeapOffset, titleHeap.data(), titleHeap.size());
+    put(h.fundIndexOffset, fundIndex.data(), fundIndex.size() * sizeof(uint32_t));
+    put(h.fundHeapOffset, fundHeap.data(), fundHeap.size());
+
+    put(0, &h, sizeof(h));
+    h.checksum = imageChecksum(image.data(), image.size());
+    put(0, &h, sizeof(h));
+}
+
+/**
+ * Point the columns into a file image
+ */
+void FrozenTable::point(const char* data) {
+    header = reinterpret_cast<const FrozenHeader*>(data);
+    pilots = reinterpret_cast<const uint32_t*>(data + header->pilotsOffset);
+    remap = reinterpret_cast<const uint32_t*>(data + header->remapOffset);
+    rows = reinterpret_cast<const FrozenRow*>(data + header->rowsOffset);
+    titleOffsets = reinterpret_cast<const uint32_t*>(data + header->titleIndexOffset);
+    titles = data + header->titleHeapOffset;
+    fundOffsets = reinterpret_cast<const uint32_t*>(data + header->fundIndexOffset);
+    fundNames = data + header->fundHeapOffset;
+}
+
+/**
+ * Check the header, the checksum and that every offset and index stays
+ * inside the file, so a damaged file can never send a read out of bounds
+ */
+void FrozenTable::validate(const string& sourcePath) {
+    const char* data = file->data();
+    size_t size = file->size();
+
+    if (size < sizeof(FrozenHeader)) {
+        throw FrozenError("file is too short");
+    }
+    const FrozenHeader* h = reinterpret_cast<const FrozenHeader*>(data);
+    if (memcmp(h->magic, FROZEN_MAGIC, sizeof(h->magic)) != 0) {
+        throw FrozenError("not a frozen table");
+    }
+    if (h->version != FROZEN_VERSION) {
+        throw FrozenError("unsupported frozen table version");
+    }
+
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (sourceStamp(sourcePath, sourceSize, sourceTime)
+            && (sourceSize != h->sourceSize || sourceTime != h->sourceTime)) {
+        throw FrozenError("frozen table is out of date");
+    }
+
+    // every section must sit inside the file, in order and aligned; a bid
+    // takes at least a row and a title offset, which bounds the count
+    // before it is used
+    uint64_t n = h->count;
+    if (h->fileSize != size
+            || n > size / (sizeof(FrozenRow) + sizeof(uint32_t))
+            || h->positions < h->count
+            || (h->count > 0 && h->buckets == 0)
+            || h->pilotsOffset < sizeof(FrozenHeader)
+            || !sectionFits(h->pilotsOffset, h->remapOffset, h->buckets, sizeof(uint32_t))
+            || !sectionFits(h->remapOffset, h->rowsOffset, h->positions - h->count, sizeof(uint32_t))
+            || !sectionFits(h->rowsOffset, h->titleIndexOffset, n, sizeof(FrozenRow))
+            || !sectionFits(h->titleIndexOffset, h->titleHeapOffset, n + 1, sizeof(uint32_t))
+            || h->titleHeapOffset > h->fundIndexOffset
+            || !sectionFits(h->fundIndexOffset, h->fundHeapOffset, uint64_t(h->fundCount) + 1, sizeof(uint32_t))
+            || h->fundHeapOffset > size
+            || ((h->pilotsOffset | h->remapOffset | h->rowsOffset
+                 | h->titleIndexOffset | h->fundIndexOffset) & 7) != 0) {
+        throw FrozenError("damaged frozen table layout");
+    }
+    if (imageChecksum(data, size) != h->checksum) {
+        throw FrozenError("checksum mismatch");
+    }
+
+    const uint32_t* remapped = reinterpret_cast<const uint32_t*>(data + h->remapOffset);
+    for (uint32_t i = 0; i < h->positions - h->count; i++) {
+        if (remapped[i] >= h->count) {
+            throw FrozenError("damaged frozen table layout");
+        }
+    }
+
+    // string offsets must stay inside their heaps
+    const uint32_t* titleIndex = reinterpret_cast<const uint32_t*>(data + h->titleIndexOffset);
+    if (titleIndex[n] > h->fundIndexOffset - h->titleHeapOffset) {
+        throw FrozenError("damaged frozen table layout");
+    }
+    for (uint64_t i = 0; i < n; i++) {
+        if (titleIndex[i] > titleIndex[i + 1]) {
+            throw FrozenError("damaged frozen table layout");
+        }
+    }
+
+    const FrozenRow* fixed = reinterpret_cast<const FrozenRow*>(data + h->rowsOffset);
+    for (uint64_t i = 0; i < n; i++) {
+        if (fixed[i].fund >= h->fundCount) {
+            throw FrozenError("damaged frozen table layout");
+        }
+    }
+    const uint32_t* fundIndex = reinterpret_cast<const uint32_t*>(data + h->fundIndexOffset);
+    if (fundIndex[h->fundCount] > size - h->fundHeapOffset) {
+        throw FrozenError("damaged frozen table layout");
+    }
+    for (uint32_t i = 0; i < h->fundCount; i++) {
+        if (fundIndex[i] > fundIndex[i + 1]) {
+            throw FrozenError("damaged frozen table layout");
+        }
+    }
+}
+
+/**
+ * Find the only slot a bid id can be in
+ */
+size_t FrozenTable::slotOf(uint32_t bidId) const {
+    uint64_t h = keyHash(bidId, header->seed);
+    size_t pos = positionOf(h, pilots[bucketOf(h, header->buckets)], header->positions);
+
+    if (pos >= header->count) {
+        pos = remap[pos - header->count];
+    }
+    return pos;
+}
+
+string_view FrozenTable::titleAt(size_t slot) const {
+    return string_view(titles + titleOffsets[slot], titleOffsets[slot + 1] - titleOffsets[slot]);
+}
+
+string_view FrozenTable::fundAt(size_t slot) const {
+    uint16_t fund = rows[slot].fund;
+    return string_view(fundNames + fundOffsets[fund], fundOffsets[fund + 1] - fundOffsets[fund]);
+}
+
+/**
+ * Print all bids, in slot order
+ */
+void FrozenTable::PrintAll() const {
+    for (size_t i = 0; i < header->count; i++) {
+        // output slot, bidID, title, amount and fund
+        cout << i << ", ";
+        cout << rows[i].bidId << ", ";
+        cout << titleAt(i) << ", ";
+        cout << rows[i].cents / 100.0 << ", ";
+        cout << fundAt(i) << endl;
+    }
+}
+
+/**
+ * Search for the specified bidId. The strings of the bid found point
+ * into the table, so they are good for as long as it is.
+ *
+ * @param bidId The bid id to search for
+ */
+ParsedBid FrozenTable::Search(uint32_t bidId) const {
+    ParsedBid bid;
+
+    if (header->count == 0) {
+        return bid;
+    }
+
+    // every id has a slot, so check it is this one
+    size_t slot = slotOf(bidId);
+    const FrozenRow& row = rows[slot];
+    if (row.bidId != bidId) {
+        return bid;
+    }
+
+    bid.bidId = bidId;
+    bid.cents = row.cents;
+    bid.title = titleAt(slot);
+    bid.fund = fundAt(slot);
+    return bid;
+}
+
+/**
+ * Returns the number of bids in the table
+ */
+size_t FrozenTable::Size() const {
+    return header->count;
+}
+
+/**
+ * Write the table to a file that can be mapped back in. It is written
+ * next to its final name first and then renamed, so a reader never sees
+ * half a file.
+ *
+ * @param path Where to write the table
+ * @param sourcePath The CSV the bids came from, used to detect staleness
+ */
+void FrozenTable::Save(const string& path, const string& sourcePath) const {
+    FrozenHeader h = *header;
+    if (!sourceStamp(sourcePath, h.sourceSize, h.sourceTime)) {
+        throw FrozenError(string("can't stat ").append(sourcePath));
+    }
+
+    string tempPath = path + ".tmp";
+    ofstream out(tempPath.c_str(), ios::out | ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(header) + sizeof(h), header->fileSize - sizeof(h));
+    out.close();
+    if (!out) {
+        remove(tempPath.c_str());
+        throw FrozenError(string("can't write ").append(tempPath));
+    }
+
+    // rename does not replace an existing file everywhere
+    remove(path.c_str());
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        remove(tempPath.c_str());
+        throw FrozenError(string("can't write ").append(path));
+    }
+}
@@ -0,0 +1,143 @@
+//============================================================================
+// Name        : FrozenTable.hpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Read-only bid table with a minimal perfect hash
+//============================================================================
+
+#ifndef FROZENTABLE_HPP
+#define FROZENTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bid.hpp"
+#include "CSVparser.hpp"
+
+/**
+ * Thrown when a frozen table cannot be written, or is missing, out of
+ * date or damaged when it is read back
+ */
+class FrozenError : public std::runtime_error {
+public:
+    FrozenError(const std::string& msg) :
+            std::runtime_error(std::string("FrozenTable : ").append(msg)) {
+    }
+};
+
+/**
+ * Fixed header at the start of a frozen table file. Like a snapshot it
+ * is little-endian with every section on an 8 byte boundary, so it is
+ * read in place from a mapping:
+ *
+ *   header | pilots uint32[buckets] | remap uint32[positions - count]
+ *          | rows FrozenRow[count]
+ *          | title offsets uint32[count + 1] | title bytes
+ *          | fund offsets uint32[fundCount + 1] | fund bytes
+ *
+ * Rows and titles are in slot order, slot i holding the bid that hashes
+ * to i.
+ */
+struct FrozenHeader {
+    char magic[8];              // "EBIDMPHF"
+    uint32_t version;           // FROZEN_VERSION
+    uint32_t count;             // number of bids, and of slots
+    uint32_t buckets;           // number of pilots
+    uint32_t positions;         // pilots place keys in [0, positions)
+    uint32_t fundCount;         // distinct fund names
+    uint32_t reserved;
+    uint64_t seed;              // of the key hash
+    uint64_t sourceSize;        // size of the CSV the bids came from
+    int64_t sourceTime;         // last write time of that CSV
+    uint64_t pilotsOffset;
+    uint64_t remapOffset;
+    uint64_t rowsOffset;
+    uint64_t titleIndexOffset;
+    uint64_t titleHeapOffset;
+    uint64_t fundIndexOffset;
+    uint64_t fundHeapOffset;
+    uint64_t fileSize;
+    uint64_t checksum;          // over the file, less the source stamp
+};
+
+/**
+ * The fixed size part of a bid, in the 16 bytes a search reads
+ */
+struct FrozenRow {
+    int64_t cents;
+    uint32_t bidId;
+    uint16_t fund;              // index of the fund name
+    uint16_t reserved;
+};
+
+const uint32_t FROZEN_VERSION = 2;
+
+/**
+ * Define a read-only table over a fixed set of bids, built with a
+ * minimal perfect hash: every bid id maps to its own slot in [0, n),
+ * so a search is one hash, one pilot and one slot read, and the id in
+ * the slot is compared to tell a hit from an id that was never added.
+ *
+ * The hash follows PTHash. Keys are split into buckets of about four;
+ * each bucket gets a pilot, the first value that, mixed into the hash,
+ * sends all its keys to free positions. Buckets are placed largest
+ * first while positions are plentiful, and there are a few more
+ * positions than keys so the last buckets still find room; the keys
+ * that land past n are sent to the slots left free below it by a small
+ * remap table.
+ *
+ * A frozen table can be saved and later mapped straight back in. Once
+ * built or mapped nothing in it changes, so any number of threads may
+ * search it at once.
+ */
+class FrozenTable {
+
+private:
+    static constexpr uint32_t AVERAGE_BUCKET = 4;
+    static constexpr double LOAD = 0.99;
+    static constexpr uint32_t MAX_PILOT = 1u << 24;  // tries before a new seed
+
+    csv::MappedFile* file = nullptr;  // set when read from a file
+    std::string image;                // the file image when built in memory
+
+    const FrozenHeader* header;
+    const uint32_t* pilots;
+    const uint32_t* remap;
+    const FrozenRow* rows;
+    const uint32_t* titleOffsets;
+    const char* titles;
+    const uint32_t* fundOffsets;
+    const char* fundNames;
+
+    static uint64_t keyHash(uint32_t bidId, uint64_t seed);
+    static size_t bucketOf(uint64_t h, uint32_t buckets);
+    static size_t positionOf(uint64_t h, uint32_t pilot, uint32_t positions);
+    static uint64_t imageChecksum(const char* data, size_t size);
+    static bool findPilots(const std::vector<uint64_t>& hashes, uint32_t buckets, uint32_t positions,
+            std::vector<uint32_t>& pilots);
+
+    void build(const std::vector<Bid>& bids);
+    void point(const char* data);
+    void validate(const std::string& sourcePath);
+    size_t slotOf(uint32_t bidId) const;
+    std::string_view titleAt(size_t slot) const;
+    std::string_view fundAt(size_t slot) const;
+
+public:
+    FrozenTable(const std::vector<Bid>& bids);
+    FrozenTable(const std::string& path, const std::string& sourcePath);
+    virtual ~FrozenTable();
+    FrozenTable(const FrozenTable&) = delete;
+    FrozenTable& operator=(const FrozenTable&) = delete;
+    void PrintAll() const;
+    ParsedBid Search(uint32_t bidId) const;
+    size_t Size() const;
+    void Save(const std::string& path, const std::string& sourcePath) const;
+};
+
+#endif // FROZENTABLE_HPP
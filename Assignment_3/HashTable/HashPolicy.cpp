@@ -0,0 +1,99 @@
+//============================================================================
+// Name        : HashPolicy.cpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Hash functions for bid ids
+//============================================================================
+
+#include <cstring>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+#include "HashPolicy.hpp"
+
+using namespace std;
+
+namespace {
+
+/**
+ * High and low halves of a 64 x 64 bit product folded together
+ */
+inline uint64_t mum(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    uint64_t aHigh = a >> 32, aLow = a & 0xFFFFFFFF;
+    uint64_t bHigh = b >> 32, bLow = b & 0xFFFFFFFF;
+    uint64_t middle1 = aHigh * bLow, middle2 = aLow * bHigh;
+    uint64_t low = aLow * bLow;
+    uint64_t high = aHigh * bHigh;
+    uint64_t carry = ((low >> 32) + (middle1 & 0xFFFFFFFF) + (middle2 & 0xFFFFFFFF)) >> 32;
+    high += (middle1 >> 32) + (middle2 >> 32) + carry;
+    low += (middle1 << 32) + (middle2 << 32);
+    return low ^ high;
+#endif
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+}
+
+/**
+ * Hash any run of bytes, in the style of wyhash: 16 bytes at a time go
+ * through one wide multiply each, so short keys cost a few cycles and
+ * every input bit reaches every output bit.
+ *
+ * @param data The bytes to hash
+ * @param length Number of bytes
+ * @param seed Picks one of many unrelated hash functions
+ * @return The hash
+ */
+uint64_t hashBytes(const void* data, size_t length, uint64_t seed) {
+    const uint64_t P0 = 0xA0761D6478BD642FULL;
+    const uint64_t P1 = 0xE7037ED1A0B428DBULL;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t a, b;
+
+    seed ^= P0;
+    if (length <= 16) {
+        if (length >= 4) {
+            // two overlapping reads cover any length from 4 to 16
+            size_t shift = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + shift);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - shift);
+        } else if (length > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t i = length;
+        for (; i > 16; i -= 16, p += 16) {
+            seed = mum(read64(p) ^ P1, read64(p + 8) ^ seed);
+        }
+        // the last 16 bytes, overlapping what came before
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+    return mum(P1 ^ length, mum(a ^ P1, b ^ seed));
+}
@@ -0,0 +1,52 @@
+//============================================================================
+// Name        : HashPolicy.hpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Hash functions for bid ids
+//============================================================================
+
+#ifndef HASHPOLICY_HPP
+#define HASHPOLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * A hash policy is a type with a static Hash(uint32_t) returning 64
+ * bits. The tables take one as a template parameter, so the call is
+ * inlined. HashTable uses the top bits of the hash and SwissTable uses
+ * both ends, so a policy must mix well into the top bits, and into the
+ * low bits too for SwissTable.
+ */
+
+// hash any run of bytes; the seed picks one of many unrelated functions
+uint64_t hashBytes(const void* data, size_t length, uint64_t seed);
+
+/**
+ * One multiply by 2^64 divided by the golden ratio. Only the top bits
+ * are well mixed, which is all HashTable needs.
+ */
+struct FibonacciHash {
+    static uint64_t Hash(uint32_t key) {
+        return key * 0x9E3779B97F4A7C15ULL;
+    }
+};
+
+/**
+ * The murmur3 finalizer, a fast integer mixer whose every output bit
+ * depends on every key bit
+ */
+struct MixHash {
+    static uint64_t Hash(uint32_t key) {
+        uint64_t h = key;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+#endif // HASHPOLICY_HPP
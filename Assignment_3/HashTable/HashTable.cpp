@@ -7,12 +7,34 @@
 //============================================================================
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 #include <string> // atoi
+#include <string_view>
+#include <thread>
 #include <time.h>
-
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define HASHTABLE_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+#include "Bid.hpp"
+#include "BidSnapshot.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
+#include "FrozenTable.hpp"
+#include "HashPolicy.hpp"
 
 using namespace std;
 
@@ -20,22 +42,151 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
-const unsigned int DEFAULT_SIZE = 179;
+// bucket counts are powers of two, so a hash is reduced to its top bits
+const unsigned int DEFAULT_SIZE = 256;
 
-// forward declarations
-double strToDouble(string str, char ch);
+// grow once there are this many bids per bucket on average
+const double DEFAULT_MAX_LOAD_FACTOR = 1.0;
 
-// define a structure to hold bid information
-struct Bid {
-    string bidId; // unique identifier
-    string title;
-    string fund;
-    double amount;
-    Bid() {
-        amount = 0.0;
-    }
+// old buckets moved by each call while an incremental rehash runs
+const unsigned int REHASH_STEP = 4;
+
+// share of searches for absent ids a filtered table lets through
+const double DEFAULT_FALSE_POSITIVE_RATE = 0.01;
+
+// how long each round of the concurrent reader driver runs
+const unsigned int READER_ROUND_MS = 500;
+
+// bids held back while loading, so a HashTable can be built a batch at a
+// time on every core without keeping the whole file in memory
+const size_t LOAD_BATCH = 1 << 16;
+
+//============================================================================
+// Table statistics
+//============================================================================
+
+/**
+ * A picture of how a table is laid out and how its searches have gone.
+ *
+ * For a chained table histogram[n] is the number of buckets holding a
+ * chain of n bids and a probe is one bid compared. For an open-addressing
+ * table histogram[n] is the number of bids found on the n-th probe and a
+ * probe is one group or slot read.
+ */
+struct TableStats {
+    string table;               // kind of table
+    string histogramOf;         // what the histogram counts
+    size_t size = 0;            // bids stored
+    size_t buckets = 0;         // buckets or slots
+    size_t usedBuckets = 0;     // buckets or slots holding a bid
+    size_t longest = 0;         // longest chain or probe
+    size_t bytes = 0;           // memory of the table itself, titles and funds excluded
+    vector<size_t> histogram;
+
+    // cumulative over every Search
+    uint64_t hits = 0;
+    uint64_t hitProbes = 0;
+    uint64_t misses = 0;
+    uint64_t missProbes = 0;
+
+    // the filter in front of Search, when there is one
+    size_t filterBytes = 0;
+    uint64_t filterRejected = 0;
+    uint64_t filterFalsePositives = 0;
+
+    void Count(size_t length);
+    double LoadFactor() const;
+    string Text() const;
+    string Json() const;
 };
 
+/**
+ * Add one chain or probe length to the histogram
+ */
+void TableStats::Count(size_t length) {
+    if (histogram.size() <= length) {
+        histogram.resize(length + 1, 0);
+    }
+    histogram[length]++;
+    longest = max(longest, length);
+}
+
+/**
+ * Returns the average number of bids per bucket or slot
+ */
+double TableStats::LoadFactor() const {
+    return buckets == 0 ? 0.0 : static_cast<double>(size) / buckets;
+}
+
+/**
+ * Returns the statistics as readable lines of text
+ */
+string TableStats::Text() const {
+    ostringstream out;
+
+    out << table << " statistics" << endl;
+    out << "  bids: " << size << endl;
+    out << "  buckets: " << buckets << ", " << usedBuckets << " used" << endl;
+    out << "  load factor: " << LoadFactor() << endl;
+    out << "  longest " << histogramOf << ": " << longest << endl;
+    out << "  bytes used: " << bytes << endl;
+    out << "  " << histogramOf << " histogram:" << endl;
+    for (size_t n = 0; n < histogram.size(); n++) {
+        if (histogram[n] != 0) {
+            out << "    " << n << ": " << histogram[n] << endl;
+        }
+    }
+
+    // average probes per search, when there were any
+    out << "  search hits: " << hits;
+    if (hits != 0) {
+        out << " (" << static_cast<double>(hitProbes) / hits << " probes each)";
+    }
+    out << endl;
+    out << "  search misses: " << misses;
+    if (misses != 0) {
+        out << " (" << static_cast<double>(missProbes) / misses << " probes each)";
+    }
+    out << endl;
+
+    if (filterBytes != 0) {
+        out << "  filter: " << filterBytes << " bytes, " << filterRejected << " misses rejected, "
+                << filterFalsePositives << " false positives" << endl;
+    }
+
+    return out.str();
+}
+
+/**
+ * Returns the statistics as one JSON object
+ */
+string TableStats::Json() const {
+    ostringstream out;
+
+    // the names are fixed words, so they need no escaping
+    out << "{\"table\":\"" << table << "\"";
+    out << ",\"size\":" << size;
+    out << ",\"buckets\":" << buckets;
+    out << ",\"usedBuckets\":" << usedBuckets;
+    out << ",\"loadFactor\":" << LoadFactor();
+    out << ",\"longest\":" << longest;
+    out << ",\"bytes\":" << bytes;
+    out << ",\"histogram\":{\"of\":\"" << histogramOf << "\",\"counts\":[";
+    for (size_t n = 0; n < histogram.size(); n++) {
+        out << (n == 0 ? "" : ",") << histogram[n];
+    }
+    out << "]}";
+    out << ",\"search\":{\"hits\":" << hits << ",\"hitProbes\":" << hitProbes;
+    out << ",\"misses\":" << misses << ",\"missProbes\":" << missProbes << "}";
+    if (filterBytes != 0) {
+        out << ",\"filter\":{\"bytes\":" << filterBytes << ",\"rejected\":" << filterRejected;
+        out << ",\"falsePositives\":" << filterFalsePositives << "}";
+    }
+    out << "}";
+
+    return out.str();
+}
+
 //============================================================================
 // Hash Table class definition
 //============================================================================
@@ -44,6 +195,7 @@ struct Bid {
  * Define a class containing data members and methods to
  * implement a hash table with chaining.
  */
+template <typename KeyHash = FibonacciHash>
 class HashTable {
 
 private:
@@ -73,27 +225,68 @@ private:
     vector<Node> nodes;
 
     unsigned int tableSize = DEFAULT_SIZE;
-
-    unsigned int hash(int key);
+    unsigned int tableBits = 0; // tableSize is 1 << tableBits
+    size_t size = 0;
+    double maxLoadFactor = DEFAULT_MAX_LOAD_FACTOR;
+
+    // During a rehash the previous buckets stay in oldNodes. Those before
+    // migrated have been moved, the rest are still live. Old bucket i
+    // splits into buckets 2i and 2i + 1, so nodes fills up in order and
+    // holds only the first 2 * migrated buckets until the rehash ends.
+    bool incremental = false;
+    vector<Node> oldNodes;
+    size_t migrated = 0;
+
+    // bids compared by Search, for Stats
+    uint64_t hits = 0;
+    uint64_t hitProbes = 0;
+    uint64_t misses = 0;
+    uint64_t missProbes = 0;
+
+    // answers most searches for absent ids, nullptr when not used
+    BloomFilter* filter = nullptr;
+
+    static unsigned int bucketOf(unsigned int key, unsigned int bits);
+    unsigned int hash(unsigned int key);
+    Node* bucketFor(uint32_t bidId, unsigned int& key);
+    void place(const Bid& bid, Node* node);
+    void grow();
+    void rehashStep(size_t buckets);
+    void printBuckets(vector<Node>& buckets, size_t first);
+    void countBuckets(vector<Node>& buckets, size_t first, TableStats& stats);
+    void fillFilter(size_t capacity);
+    void placeBatch(const vector<Bid>& bids, unsigned int threads);
 
 public:
     HashTable();
     HashTable(unsigned int size);
     virtual ~HashTable();
     void Insert(Bid bid);
+    void InsertBatch(const vector<Bid>& bids, unsigned int threads);
     void PrintAll();
-    void Remove(string bidId);
-    Bid Search(string bidId);
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
     size_t Size();
+    double LoadFactor();
+    void SetMaxLoadFactor(double loadFactor);
+    void SetIncrementalRehash(bool enabled);
+    bool Rehashing();
+    TableStats Stats();
+    FrozenTable* Freeze();
+    void SetFilter(double falsePositiveRate, size_t maxBytes);
 };
 
 /**
  * Default constructor
  */
-HashTable::HashTable() {
+template <typename KeyHash>
+HashTable<KeyHash>::HashTable() {
     // FIXME (1): Initialize the structures used to hold bids
 
     // Initalize node structure by resizing tableSize
+    while ((1u << tableBits) < tableSize) {
+        tableBits++;
+    }
     nodes.resize(tableSize);
 }
 
@@ -101,33 +294,44 @@ HashTable::HashTable() {
  * Constructor for specifying size of the table
  * Use to improve efficiency of hashing algorithm
  * by reducing collisions without wasting memory.
+ * The size is rounded up to a power of two, at least 2.
  */
-HashTable::HashTable(unsigned int size) {
+template <typename KeyHash>
+HashTable<KeyHash>::HashTable(unsigned int size) {
     // invoke local tableSize to size with this->
-    this->tableSize = size;
+    this->tableBits = 1;
+    while ((1u << this->tableBits) < size) {
+        this->tableBits++;
+    }
+    this->tableSize = 1u << this->tableBits;
 
     // resize nodes size
-    nodes.resize(size);
+    nodes.resize(this->tableSize);
 }
 
 
 /**
  * Destructor
  */
-HashTable::~HashTable() {
+template <typename KeyHash>
+HashTable<KeyHash>::~HashTable() {
     // FIXME (2): Implement logic to free storage when class is destroyed
     
-    // erase nodes beginning
-    for (int i = 0; i < nodes.size(); i++) {
-        Node* current = nodes[i].next;
+    // erase nodes beginning, in both tables while a rehash is under way
+    for (vector<Node>* table : { &oldNodes, &nodes }) {
+        for (size_t i = 0; i < table->size(); i++) {
+            Node* current = (*table)[i].next;
 
-        // loop over each node, detach from list then delete
-        while (current != nullptr) {
-            Node* temp = current; // hang on to current node
-            current = current->next; // make current the next node
-            delete temp; // delete the orphan node
+            // loop over each node, detach from list then delete
+            while (current != nullptr) {
+                Node* temp = current; // hang on to current node
+                current = current->next; // make current the next node
+                delete temp; // delete the orphan node
+            }
         }
     }
+
+    delete filter;
 }
 
 /**
@@ -139,38 +343,57 @@ HashTable::~HashTable() {
  * @param key The key to hash
  * @return The calculated hash
  */
-unsigned int HashTable::hash(int key) {
+template <typename KeyHash>
+unsigned int HashTable<KeyHash>::hash(unsigned int key) {
     // FIXME (3): Implement logic to calculate a hash value
     
-    // return key tableSize
-    return key % tableSize;
+    return bucketOf(key, tableBits);
     
 }
 
+/**
+ * Pick a bucket in a table of 1 << bits buckets from the top bits of the
+ * hash, so the bucket in a table twice as big is 2 * bucket or
+ * 2 * bucket + 1.
+ */
+template <typename KeyHash>
+unsigned int HashTable<KeyHash>::bucketOf(unsigned int key, unsigned int bits) {
+    return static_cast<unsigned int>(KeyHash::Hash(key) >> (64 - bits));
+}
+
 /**
  * Insert a bid
  *
  * @param bid The bid to insert
  */
-void HashTable::Insert(Bid bid) {
+template <typename KeyHash>
+void HashTable<KeyHash>::Insert(Bid bid) {
     // FIXME (4): Implement logic to insert a bid
+
+    // keep chains short by doubling the buckets past the load factor
+    if (size + 1 > maxLoadFactor * tableSize) {
+        grow();
+    }
+    rehashStep(REHASH_STEP);
+    size++;
     
     // create the key for the given bid
-    unsigned int key = hash(stoi(bid.bidId));
+    unsigned int key;
     
     // retrieve node using key
+    Node* bucket = bucketFor(bid.bidId, key);
 
     // if no entry found for the key
-    if (nodes[key].key == UINT_MAX) {
+    if (bucket->key == UINT_MAX) {
         // assign this node to the key position
-        nodes[key].bid = bid;
-        nodes[key].key = key;
-        nodes[key].next = nullptr;
+        bucket->bid = bid;
+        bucket->key = key;
+        bucket->next = nullptr;
     }
     // else find the next open node
     else {
         // add new newNode to end
-        Node* current = &nodes[key];
+        Node* current = bucket;
 
         while (current->next != nullptr) {
             current = current->next;
@@ -179,26 +402,182 @@ void HashTable::Insert(Bid bid) {
         Node* newNode = new Node(bid, key);
         current->next = newNode;
     }
+
+    if (filter != nullptr) {
+        filter->Add(bid.bidId);
+        if (filter->Full()) {
+            fillFilter(filter->Capacity() * 2);
+        }
+    }
+}
+
+/**
+ * Insert many bids at once, building the table on several threads.
+ *
+ * The table is grown up front to fit every bid. The bids are then split
+ * by the top bits of their hash into partitions; since buckets are also
+ * picked by the top bits, each partition covers its own contiguous range
+ * of buckets and the threads fill their partitions without locking.
+ * Bids of one bucket keep their order in the batch, so the chains come
+ * out as if the bids had been inserted one at a time.
+ *
+ * A table that rehashes incrementally takes the bids one at a time
+ * instead. Placing a batch needs every bucket in place, which means
+ * finishing the rehash in one go, the very pause incremental rehashing
+ * is there to avoid; inserted one at a time, each bid moves only its
+ * share of the old buckets.
+ *
+ * @param bids The bids to insert
+ * @param threads How many threads to build with
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::InsertBatch(const vector<Bid>& bids, unsigned int threads) {
+    if (incremental) {
+        for (const Bid& bid : bids) {
+            Insert(bid);
+        }
+        return;
+    }
+
+    // finish a rehash under way, then double until everything fits
+    rehashStep(oldNodes.size());
+    while (size + bids.size() > maxLoadFactor * tableSize) {
+        grow();
+        rehashStep(oldNodes.size());
+    }
+    size += bids.size();
+
+    // below a few thousand bids per thread the threads cost more than they save
+    threads = max(1u, min<unsigned int>(threads, static_cast<unsigned int>(bids.size() / 4096)));
+    if (threads == 1) {
+        for (const Bid& bid : bids) {
+            place(bid, nullptr);
+        }
+    } else {
+        placeBatch(bids, threads);
+    }
+
+    // the filter is sized for the whole table once
+    if (filter != nullptr) {
+        if (size > filter->Capacity()) {
+            fillFilter(size);
+        } else {
+            for (const Bid& bid : bids) {
+                filter->Add(bid.bidId);
+            }
+        }
+    }
+}
+
+/**
+ * Place a batch of bids on several threads, each filling its own
+ * buckets. The table has room for them already.
+ *
+ * @param bids The bids to place
+ * @param threads How many threads to place them with
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::placeBatch(const vector<Bid>& bids, unsigned int threads) {
+    // a few partitions per thread evens out the work
+    unsigned int partitionBits = 0;
+    while ((1u << partitionBits) < threads * 8 && partitionBits < tableBits) {
+        partitionBits++;
+    }
+    size_t partitions = size_t(1) << partitionBits;
+    size_t chunk = (bids.size() + threads - 1) / threads;
+
+    // runs work(0) .. work(threads - 1), each on its own thread
+    auto parallel = [threads](const function<void(unsigned int)>& work) {
+        vector<thread> pool;
+        for (unsigned int t = 1; t < threads; t++) {
+            pool.push_back(thread(work, t));
+        }
+        work(0);
+        for (thread& worker : pool) {
+            worker.join();
+        }
+    };
+    auto partitionOf = [partitionBits](uint32_t bidId) {
+        return static_cast<size_t>(bucketOf(bidId, partitionBits));
+    };
+
+    // count the bids of every partition in each thread's slice of the batch
+    vector<size_t> offsets(threads * partitions, 0);
+    parallel([&](unsigned int t) {
+        size_t* count = &offsets[t * partitions];
+        size_t end = min(bids.size(), (t + 1) * chunk);
+        for (size_t i = t * chunk; i < end; i++) {
+            count[partitionOf(bids[i].bidId)]++;
+        }
+    });
+
+    // turn the counts into where each thread writes in each partition,
+    // thread 0 first so the batch order survives
+    vector<size_t> starts(partitions + 1, 0);
+    size_t total = 0;
+    for (size_t p = 0; p < partitions; p++) {
+        starts[p] = total;
+        for (unsigned int t = 0; t < threads; t++) {
+            size_t count = offsets[t * partitions + p];
+            offsets[t * partitions + p] = total;
+            total += count;
+        }
+    }
+    starts[partitions] = total;
+
+    vector<const Bid*> sorted(bids.size());
+    parallel([&](unsigned int t) {
+        size_t* next = &offsets[t * partitions];
+        size_t end = min(bids.size(), (t + 1) * chunk);
+        for (size_t i = t * chunk; i < end; i++) {
+            sorted[next[partitionOf(bids[i].bidId)]++] = &bids[i];
+        }
+    });
+
+    // each partition only touches its own buckets
+    atomic<size_t> nextPartition(0);
+    parallel([&](unsigned int) {
+        size_t p;
+        while ((p = nextPartition.fetch_add(1)) < partitions) {
+            for (size_t i = starts[p]; i < starts[p + 1]; i++) {
+                place(*sorted[i], nullptr);
+            }
+        }
+    });
 }
 
 /**
  * Print all bids
  */
-void HashTable::PrintAll() {
+template <typename KeyHash>
+void HashTable<KeyHash>::PrintAll() {
     // FIXME (5): Implement logic to print all bids
+    // buckets not yet moved by a rehash first, then the current ones
+    printBuckets(oldNodes, migrated);
+    printBuckets(nodes, 0);
+}
+
+/**
+ * Print the bids in a range of buckets
+ *
+ * @param buckets The bucket array to print
+ * @param first The first bucket to print
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::printBuckets(vector<Node>& buckets, size_t first) {
     // for node begin to end iterate
-    for (int i = 0; i < nodes.size(); i++) {
+    for (size_t i = first; i < buckets.size(); i++) {
         //   if key not equal to UINT_MAx
-        if (nodes[i].key != UINT_MAX) {
+        if (buckets[i].key != UINT_MAX) {
             // output key, bidID, title, amount and fund
-            cout << nodes[i].key << ", ";
-            cout << nodes[i].bid.bidId << ", ";
-            cout << nodes[i].bid.title << ", "; 
-            cout << nodes[i].bid.amount << ", ";
-            cout << nodes[i].bid.fund << endl;
+            cout << buckets[i].key << ", ";
+            cout << buckets[i].bid.bidId << ", ";
+            cout << buckets[i].bid.Title() << ", "; 
+            cout << buckets[i].bid.Amount() << ", ";
+            cout << buckets[i].bid.Fund() << endl;
             
             // node is equal to next iter
-            Node* current = nodes[i].next;
+            Node* current = buckets[i].next;
 
             // while node not equal to nullptr
             // prints the each node in the chain
@@ -207,9 +586,9 @@ void HashTable::PrintAll() {
                 // output key, bidID, title, amount and fund
                 cout << current->key << ", ";
                 cout << current->bid.bidId << ", ";
-                cout << current->bid.title << ", ";
-                cout << current->bid.amount << ", ";
-                cout << current->bid.fund << endl;
+                cout << current->bid.Title() << ", ";
+                cout << current->bid.Amount() << ", ";
+                cout << current->bid.Fund() << endl;
 
                 // node is equal to next node
                 current = current->next;
@@ -224,16 +603,19 @@ void HashTable::PrintAll() {
  *
  * @param bidId The bid id to search for
  */
-void HashTable::Remove(string bidId) {
+template <typename KeyHash>
+void HashTable<KeyHash>::Remove(uint32_t bidId) {
     // FIXME (6): Implement logic to remove a bid
+    rehashStep(REHASH_STEP);
+
     // set key equal to hash atoi bidID cstring
-    unsigned int key = hash(atoi(bidId.c_str()));
+    unsigned int key;
 
-    Node* current = &nodes[key];
+    Node* current = bucketFor(bidId, key);
 
     // erase node begin and key
     // if there is no entry in this bucket
-    if (nodes[key].key == UINT_MAX) {
+    if (current->key == UINT_MAX) {
 
         cout << "BidId: " << bidId << " is not found!" << endl;
 
@@ -244,44 +626,40 @@ void HashTable::Remove(string bidId) {
     if (current->bid.bidId == bidId) {
         // no chain exists, therefore clear the bucket
         if (current->next == nullptr) {
-            nodes[key].key = UINT_MAX;
+            current->key = UINT_MAX;
         }
-        // if a chain exists
+        // if a chain exists, the next node moves into the bucket
         else {
 
             Node* temp = current->next;
-            current->bid = current->next->bid;
-            current->key = current->next->key;
+            current->bid = temp->bid;
+            current->key = temp->key;
             current->next = temp->next;
 
             delete temp;
         }
 
+        size--;
         return;
         
     }
-    // search through the chain
-    else {
-        Node* prev = current;
-        current = current->next;
-
-        // while loop over each node looking for a match
-        while (current != nullptr && current->next != nullptr) {
-            // if the next node bidID is equal to the current bidID
-            if (current->next->bid.bidId == bidId) {
-                // hold onto the next node temporarily
-                prev->next = current->next;
 
-                // free the memory space
-                delete current;
-
-                //return
-                return;
-            }
+    // search through the chain
+    Node* prev = current;
+    current = current->next;
 
-            prev = current;
-            current = current->next;
+    // while loop over each node looking for a match
+    while (current != nullptr) {
+        // unlink the matching node and free it
+        if (current->bid.bidId == bidId) {
+            prev->next = current->next;
+            delete current;
+            size--;
+            return;
         }
+
+        prev = current;
+        current = current->next;
     }
 
     // if no bid is found
@@ -293,34 +671,53 @@ void HashTable::Remove(string bidId) {
  *
  * @param bidId The bid id to search for
  */
-Bid HashTable::Search(string bidId) {
+template <typename KeyHash>
+Bid HashTable<KeyHash>::Search(uint32_t bidId) {
     Bid bid;
 
     // FIXME (7): Implement logic to search for and return a bid
 
+    rehashStep(REHASH_STEP);
+
+    // most ids that were never added stop at the filter
+    if (filter != nullptr && !filter->MayContain(bidId)) {
+        misses++;
+        return bid;
+    }
+
     // create the key for the given bid
-    unsigned int key = hash(atoi(bidId.c_str()));
+    unsigned int key;
 
-    Node* current = &nodes[key];
+    Node* current = bucketFor(bidId, key);
 
     // if no entry found for the key
-    if (nodes[key].key == UINT_MAX) {
+    if (current->key == UINT_MAX) {
+        misses++;
+        if (filter != nullptr) {
+            filter->CountFalsePositive();
+        }
         // return an empty bid
         return bid;
     }
     
     // if entry found for the key
-    if (nodes[key].bid.bidId == bidId) {
+    uint64_t probes = 1;
+    if (current->bid.bidId == bidId) {
+        hits++;
+        hitProbes += probes;
         //return node bid
-        return nodes[key].bid;
+        return current->bid;
     }
 
-    current = nodes[key].next;
+    current = current->next;
 
     // while node not equal to nullptr
     while (current != nullptr) {
+        probes++;
         // if the current node matches, return it
         if (current->bid.bidId == bidId) {
+            hits++;
+            hitProbes += probes;
             //return the current bid
             return current->bid;
             
@@ -331,159 +728,1556 @@ Bid HashTable::Search(string bidId) {
         }
     }
 
+    misses++;
+    missProbes += probes;
+    if (filter != nullptr) {
+        filter->CountFalsePositive();
+    }
     return bid;
 }
 
-//============================================================================
-// Static methods used for testing
-//============================================================================
+/**
+ * Returns the number of bids in the table
+ */
+template <typename KeyHash>
+size_t HashTable<KeyHash>::Size() {
+    return size;
+}
 
 /**
- * Display the bid information to the console (std::out)
+ * Returns the average number of bids per bucket
+ */
+template <typename KeyHash>
+double HashTable<KeyHash>::LoadFactor() {
+    return static_cast<double>(size) / tableSize;
+}
+
+/**
+ * Set how many bids per bucket the table allows before it doubles
  *
- * @param bid struct containing the bid info
+ * @param loadFactor The new threshold, greater than zero
  */
-void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-            << bid.fund << endl;
-    return;
+template <typename KeyHash>
+void HashTable<KeyHash>::SetMaxLoadFactor(double loadFactor) {
+    if (loadFactor <= 0.0) {
+        return;
+    }
+    maxLoadFactor = loadFactor;
+    while (size > maxLoadFactor * tableSize) {
+        grow();
+    }
+    rehashStep(oldNodes.size());
 }
 
 /**
- * Load a CSV file containing bids into a container
+ * Grow by moving a few buckets per Insert, Search and Remove instead of
+ * all at once, so no single call pays for rehashing the whole table.
  *
- * @param csvPath the path to the CSV file to load
- * @return a container holding all the bids read
+ * @param enabled true to rehash incrementally from the next growth on
  */
-void loadBids(string csvPath, HashTable* hashTable) {
-    cout << "Loading CSV file " << csvPath << endl;
+template <typename KeyHash>
+void HashTable<KeyHash>::SetIncrementalRehash(bool enabled) {
+    incremental = enabled;
+    if (!incremental) {
+        rehashStep(oldNodes.size());
+    }
+}
 
-    // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+/**
+ * Returns true while an incremental rehash is moving bids
+ */
+template <typename KeyHash>
+bool HashTable<KeyHash>::Rehashing() {
+    return !oldNodes.empty();
+}
 
-    // read and display header row - optional
-    vector<string> header = file.getHeader();
-    for (auto const& c : header) {
-        cout << c << " | ";
+/**
+ * Returns the layout of the table and the probes made by Search so far
+ */
+template <typename KeyHash>
+TableStats HashTable<KeyHash>::Stats() {
+    TableStats stats;
+    stats.table = "HashTable";
+    stats.histogramOf = "chain length";
+    stats.size = size;
+    stats.buckets = tableSize;
+    stats.bytes = sizeof(*this) + (nodes.capacity() + oldNodes.capacity()) * sizeof(Node);
+    if (filter != nullptr) {
+        stats.filterBytes = filter->Bytes();
+        stats.filterRejected = filter->Rejected();
+        stats.filterFalsePositives = filter->FalsePositives();
+        stats.bytes += sizeof(BloomFilter) + filter->Bytes();
     }
-    cout << "" << endl;
 
-    try {
-        // loop to read rows of a CSV file
-        for (unsigned int i = 0; i < file.rowCount(); i++) {
-
-            // Create a data structure and add to the collection of bids
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+    // buckets not yet moved by a rehash, then the current ones
+    countBuckets(oldNodes, migrated, stats);
+    countBuckets(nodes, 0, stats);
 
-            //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
+    stats.hits = hits;
+    stats.hitProbes = hitProbes;
+    stats.misses = misses;
+    stats.missProbes = missProbes;
+    return stats;
+}
 
-            // push this bid to the end
-            hashTable->Insert(bid);
+/**
+ * Add the chains of a range of buckets to the statistics
+ *
+ * @param buckets The bucket array to count
+ * @param first The first bucket to count
+ * @param stats Where to add them
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::countBuckets(vector<Node>& buckets, size_t first, TableStats& stats) {
+    for (size_t i = first; i < buckets.size(); i++) {
+        size_t length = 0;
+        if (buckets[i].key != UINT_MAX) {
+            length = 1;
+            for (Node* current = buckets[i].next; current != nullptr; current = current->next) {
+                length++;
+                stats.bytes += sizeof(Node);
+            }
+            stats.usedBuckets++;
         }
-    } catch (csv::Error &e) {
-        std::cerr << e.what() << std::endl;
+        stats.Count(length);
     }
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
- *
- * credit: http://stackoverflow.com/a/24875936
+ * Put a Bloom filter in front of Search, so most searches for ids that
+ * were never added return without reading a bucket. Removed ids stay
+ * in the filter until it fills up and is rebuilt from the table.
  *
- * @param ch The character to strip out
+ * @param falsePositiveRate The share of absent ids let through
+ * @param maxBytes Most memory the filter may use, 0 for no limit
  */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+template <typename KeyHash>
+void HashTable<KeyHash>::SetFilter(double falsePositiveRate, size_t maxBytes) {
+    delete filter;
+    filter = new BloomFilter(max<size_t>(size, DEFAULT_SIZE), falsePositiveRate, maxBytes);
+    fillFilter(filter->Capacity());
 }
 
 /**
- * The one and only main() method
+ * Clear the filter, size it for a number of bids and add every bid in
+ * the table
  */
-int main(int argc, char* argv[]) {
+template <typename KeyHash>
+void HashTable<KeyHash>::fillFilter(size_t capacity) {
+    filter->Reset(capacity);
+    for (vector<Node>* table : { &oldNodes, &nodes }) {
+        size_t first = table == &oldNodes ? migrated : 0;
+        for (size_t i = first; i < table->size(); i++) {
+            if ((*table)[i].key == UINT_MAX) {
+                continue;
+            }
+            filter->Add((*table)[i].bid.bidId);
+            for (Node* current = (*table)[i].next; current != nullptr; current = current->next) {
+                filter->Add(current->bid.bidId);
+            }
+        }
+    }
+}
 
-    // process command line arguments
-    string csvPath, bidKey;
-    switch (argc) {
-    case 2:
-        csvPath = argv[1];
-        bidKey = "98223";
-        break;
-    case 3:
-        csvPath = argv[1];
-        bidKey = argv[2];
-        break;
-    default:
-        csvPath = "eBid_Monthly_Sales.csv";
-        bidKey = "98223";
+/**
+ * Find the bucket that holds, or would hold, a bid id. During a rehash
+ * that is the old bucket until it has been moved, the new one after.
+ *
+ * @param bidId The bid id
+ * @param key Set to the index of the bucket in its table
+ * @return The bucket
+ */
+template <typename KeyHash>
+typename HashTable<KeyHash>::Node* HashTable<KeyHash>::bucketFor(uint32_t bidId, unsigned int& key) {
+    if (Rehashing()) {
+        unsigned int oldKey = bucketOf(bidId, tableBits - 1);
+        if (oldKey >= migrated) {
+            key = oldKey;
+            return &oldNodes[oldKey];
+        }
     }
 
-    // Define a timer variable
-    clock_t ticks;
+    key = hash(bidId);
+    return &nodes[key];
+}
+
+/**
+ * Move some of the old buckets into the current table
+ *
+ * @param buckets How many non-empty buckets to move; at most ten times
+ *        as many empty ones are skipped, which bounds the work
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::rehashStep(size_t buckets) {
+    if (!Rehashing()) {
+        return;
+    }
 
-    // Define a hash table to hold all the bids
-    HashTable* bidTable;
+    size_t emptyVisits = buckets * 10;
+    while (buckets > 0 && migrated < oldNodes.size()) {
+        Node& bucket = oldNodes[migrated++];
 
-    Bid bid;
-    bidTable = new HashTable();
-    
-    int choice = 0;
-    while (choice != 9) {
-        cout << "Menu:" << endl;
-        cout << "  1. Load Bids" << endl;
-        cout << "  2. Display All Bids" << endl;
-        cout << "  3. Find Bid" << endl;
-        cout << "  4. Remove Bid" << endl;
-        cout << "  9. Exit" << endl;
-        cout << "Enter choice: ";
-        cin >> choice;
+        // the two buckets this one splits into; nodes has room reserved
+        nodes.push_back(Node());
+        nodes.push_back(Node());
 
-        switch (choice) {
+        if (bucket.key == UINT_MAX) {
+            if (--emptyVisits == 0) {
+                break;
+            }
+            continue;
+        }
 
-        case 1:
-            
-            // Initialize a timer variable before loading bids
-            ticks = clock();
+        // the bid stored in the old bucket itself comes first
+        place(bucket.bid, nullptr);
 
-            // Complete the method call to load the bids
-            loadBids(csvPath, bidTable);
+        Node* chain = bucket.next;
+        while (chain != nullptr) {
+            Node* next = chain->next;
+            place(chain->bid, chain);
+            chain = next;
+        }
 
-            // Calculate elapsed time and display result
-            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
-            cout << "time: " << ticks << " clock ticks" << endl;
-            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
-            break;
+        bucket.key = UINT_MAX;
+        bucket.next = nullptr;
+        buckets--;
+    }
 
-        case 2:
-            bidTable->PrintAll();
-            break;
+    // every bid has moved, drop the old table
+    if (migrated == oldNodes.size()) {
+        vector<Node>().swap(oldNodes);
+        migrated = 0;
+    }
+}
 
-        case 3:
-            ticks = clock();
+/**
+ * Put a bid at the end of its chain, or in the bucket itself when that
+ * is empty
+ *
+ * @param bid The bid to place
+ * @param node A node no longer in any chain to link in, nullptr to
+ *        allocate one if needed; freed if the bid goes in the bucket
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::place(const Bid& bid, Node* node) {
+    unsigned int key = hash(bid.bidId);
+    Node* current = &nodes[key];
 
-            bid = bidTable->Search(bidKey);
+    if (current->key == UINT_MAX) {
+        current->bid = bid;
+        current->key = key;
+        delete node;
+        return;
+    }
 
-            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+    if (node == nullptr) {
+        node = new Node(bid);
+    }
+    node->key = key;
+    node->next = nullptr;
 
-            if (!bid.bidId.empty()) {
-                displayBid(bid);
-            } else {
-                cout << "Bid Id " << bidKey << " not found." << endl;
-            }
+    while (current->next != nullptr) {
+        current = current->next;
+    }
+    current->next = node;
+}
 
-            cout << "time: " << ticks << " clock ticks" << endl;
-            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
-            break;
+/**
+ * Double the number of buckets. The new buckets are only reserved here;
+ * they are created as the old ones are moved, all at once or, with
+ * incremental rehashing, a few per call.
+ */
+template <typename KeyHash>
+void HashTable<KeyHash>::grow() {
+    // a rehash still under way is finished first
+    rehashStep(oldNodes.size());
+
+    oldNodes.swap(nodes);
+    nodes.reserve(oldNodes.size() * 2);
+    tableSize *= 2;
+    tableBits++;
+    migrated = 0;
+
+    if (!incremental) {
+        rehashStep(oldNodes.size());
+    }
+}
 
-        case 4:
-            bidTable->Remove(bidKey);
-            break;
+//============================================================================
+// Swiss Table class definition
+//============================================================================
+
+/**
+ * Define a class with the same interface as HashTable that keeps its
+ * bids in one flat array instead of chains (open addressing).
+ *
+ * Next to the slots is an array of control bytes, one per slot: empty,
+ * deleted, or the low 7 bits of the hash of the bid stored there. A
+ * lookup reads the control bytes sixteen at a time and compares all of
+ * them against the hash bits in one SSE2 instruction, so only slots that
+ * very likely hold the key are read. A hit usually costs one control
+ * group and one slot, a miss usually just the control group.
+ *
+ * Inserting a bid id that is already stored replaces that bid.
+ */
+template <typename KeyHash = MixHash>
+class SwissTable {
+
+private:
+    static constexpr int GROUP = 16;            // control bytes matched at once
+    static constexpr int8_t EMPTY = -128;       // 0b10000000
+    static constexpr int8_t DELETED = -2;       // 0b11111110
+
+    vector<int8_t> ctrl;    // capacity bytes, then the first GROUP repeated
+    vector<Bid> slots;
+    size_t capacity;        // a power of two, at least GROUP
+    size_t size;
+    size_t growthLeft;      // inserts into empty slots before a rehash
+
+    // control groups read by Search, for Stats
+    uint64_t hits = 0;
+    uint64_t hitProbes = 0;
+    uint64_t misses = 0;
+    uint64_t missProbes = 0;
+
+    static uint64_t hash(uint32_t key);
+    static uint32_t matchByte(const int8_t* group, int8_t value);
+    static int lowestBit(uint32_t mask);
+
+    void setCtrl(size_t i, int8_t value);
+    size_t find(uint32_t bidId);
+    size_t find(uint32_t bidId, uint64_t& groups);
+    size_t findFree(uint64_t hash);
+    void resize(size_t newCapacity);
+
+public:
+    SwissTable();
+    SwissTable(size_t expected);
+    virtual ~SwissTable();
+    void Insert(Bid bid);
+    void PrintAll();
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
+    size_t Size();
+    TableStats Stats();
+};
+
+/**
+ * Default constructor
+ */
+template <typename KeyHash>
+SwissTable<KeyHash>::SwissTable() : SwissTable(0) {
+}
+
+/**
+ * Constructor sizing the table for a number of bids up front
+ *
+ * @param expected How many bids will be inserted
+ */
+template <typename KeyHash>
+SwissTable<KeyHash>::SwissTable(size_t expected) {
+    capacity = 0;
+    size = 0;
+    growthLeft = 0;
+
+    // keep the table at most 7/8 full
+    size_t wanted = GROUP;
+    while (wanted - wanted / 8 < expected) {
+        wanted *= 2;
+    }
+    resize(wanted);
+}
+
+/**
+ * Destructor
+ */
+template <typename KeyHash>
+SwissTable<KeyHash>::~SwissTable() {
+    // the vectors free the slots and control bytes
+}
+
+/**
+ * Hash a bid id with the hash policy. The top bits pick where the probe
+ * starts, the low 7 bits go into the control byte.
+ */
+template <typename KeyHash>
+uint64_t SwissTable<KeyHash>::hash(uint32_t key) {
+    return KeyHash::Hash(key);
+}
+
+/**
+ * Compare sixteen control bytes against a value
+ *
+ * @param group The first of the control bytes
+ * @param value The byte to look for
+ * @return A mask with bit i set when group[i] equals value
+ */
+template <typename KeyHash>
+uint32_t SwissTable<KeyHash>::matchByte(const int8_t* group, int8_t value) {
+#ifdef HASHTABLE_SSE2
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < GROUP; i++) {
+        if (group[i] == value) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Returns the index of the lowest set bit of a non-zero mask
+ */
+template <typename KeyHash>
+int SwissTable<KeyHash>::lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long pos;
+    _BitScanForward(&pos, mask);
+    return static_cast<int>(pos);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Set the control byte of a slot. The first GROUP bytes are repeated
+ * after the last one, so a group read near the end wraps around.
+ */
+template <typename KeyHash>
+void SwissTable<KeyHash>::setCtrl(size_t i, int8_t value) {
+    ctrl[i] = value;
+    if (i < GROUP) {
+        ctrl[capacity + i] = value;
+    }
+}
+
+/**
+ * Find the slot holding a bid id
+ *
+ * @return The slot, or capacity if the id is not in the table
+ */
+template <typename KeyHash>
+size_t SwissTable<KeyHash>::find(uint32_t bidId) {
+    uint64_t groups = 0;
+    return find(bidId, groups);
+}
+
+/**
+ * Find the slot holding a bid id
+ *
+ * @param groups Set to the number of control groups read
+ * @return The slot, or capacity if the id is not in the table
+ */
+template <typename KeyHash>
+size_t SwissTable<KeyHash>::find(uint32_t bidId, uint64_t& groups) {
+    uint64_t h = hash(bidId);
+    int8_t tag = static_cast<int8_t>(h & 0x7F);
+    size_t mask = capacity - 1;
+    size_t pos = (h >> 7) & mask;
+
+    // visit groups at growing distances; an empty byte ends the probe
+    for (size_t step = GROUP; ; step += GROUP) {
+        const int8_t* group = &ctrl[pos];
+        groups++;
+        for (uint32_t match = matchByte(group, tag); match != 0; match &= match - 1) {
+            size_t i = (pos + lowestBit(match)) & mask;
+            if (slots[i].bidId == bidId) {
+                return i;
+            }
+        }
+        if (matchByte(group, EMPTY) != 0) {
+            return capacity;
+        }
+        pos = (pos + step) & mask;
+    }
+}
+
+/**
+ * Find the first empty or deleted slot on the probe path of a hash
+ */
+template <typename KeyHash>
+size_t SwissTable<KeyHash>::findFree(uint64_t h) {
+    size_t mask = capacity - 1;
+    size_t pos = (h >> 7) & mask;
+
+    for (size_t step = GROUP; ; step += GROUP) {
+        const int8_t* group = &ctrl[pos];
+        // empty and deleted are the only bytes with the top bit set
+#ifdef HASHTABLE_SSE2
+        uint32_t free = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+        uint32_t free = matchByte(group, EMPTY) | matchByte(group, DELETED);
+#endif
+        if (free != 0) {
+            return (pos + lowestBit(free)) & mask;
+        }
+        pos = (pos + step) & mask;
+    }
+}
+
+/**
+ * Move every bid into a fresh table, which also clears deleted slots
+ *
+ * @param newCapacity Slots in the new table, a power of two
+ */
+template <typename KeyHash>
+void SwissTable<KeyHash>::resize(size_t newCapacity) {
+    vector<int8_t> oldCtrl(newCapacity + GROUP, EMPTY);
+    vector<Bid> oldSlots(newCapacity);
+    oldCtrl.swap(ctrl);
+    oldSlots.swap(slots);
+    size_t oldCapacity = capacity;
+
+    capacity = newCapacity;
+    growthLeft = capacity - capacity / 8 - size;
+
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldCtrl[i] >= 0) {
+            uint64_t h = hash(oldSlots[i].bidId);
+            size_t slot = findFree(h);
+            setCtrl(slot, static_cast<int8_t>(h & 0x7F));
+            slots[slot] = oldSlots[i];
+        }
+    }
+}
+
+/**
+ * Insert a bid
+ *
+ * @param bid The bid to insert
+ */
+template <typename KeyHash>
+void SwissTable<KeyHash>::Insert(Bid bid) {
+    size_t found = find(bid.bidId);
+    if (found != capacity) {
+        slots[found] = bid;
+        return;
+    }
+
+    uint64_t h = hash(bid.bidId);
+    size_t slot = findFree(h);
+
+    // a deleted slot can be reused freely, an empty one uses up growth
+    if (ctrl[slot] == EMPTY) {
+        if (growthLeft == 0) {
+            // mostly deleted slots: clean up in place, else double
+            resize(size < capacity / 2 ? capacity : capacity * 2);
+            slot = findFree(h);
+        }
+        growthLeft--;
+    }
+
+    setCtrl(slot, static_cast<int8_t>(h & 0x7F));
+    slots[slot] = bid;
+    size++;
+}
+
+/**
+ * Print all bids
+ */
+template <typename KeyHash>
+void SwissTable<KeyHash>::PrintAll() {
+    for (size_t i = 0; i < capacity; i++) {
+        if (ctrl[i] >= 0) {
+            // output slot, bidID, title, amount and fund
+            cout << i << ", ";
+            cout << slots[i].bidId << ", ";
+            cout << slots[i].Title() << ", ";
+            cout << slots[i].Amount() << ", ";
+            cout << slots[i].Fund() << endl;
+        }
+    }
+}
+
+/**
+ * Remove a bid
+ *
+ * @param bidId The bid id to remove
+ */
+template <typename KeyHash>
+void SwissTable<KeyHash>::Remove(uint32_t bidId) {
+    size_t slot = find(bidId);
+
+    if (slot == capacity) {
+        cout << "Bid ID: " << bidId << " is not found!" << endl;
+        return;
+    }
+
+    // probes for other keys may pass through this slot, so it is
+    // marked deleted rather than empty
+    setCtrl(slot, DELETED);
+    slots[slot] = Bid();
+    size--;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+template <typename KeyHash>
+Bid SwissTable<KeyHash>::Search(uint32_t bidId) {
+    uint64_t groups = 0;
+    size_t slot = find(bidId, groups);
+
+    if (slot == capacity) {
+        misses++;
+        missProbes += groups;
+        return Bid();
+    }
+    hits++;
+    hitProbes += groups;
+    return slots[slot];
+}
+
+/**
+ * Returns the number of bids in the table
+ */
+template <typename KeyHash>
+size_t SwissTable<KeyHash>::Size() {
+    return size;
+}
+
+/**
+ * Returns the layout of the table and the probes made by Search so far
+ */
+template <typename KeyHash>
+TableStats SwissTable<KeyHash>::Stats() {
+    TableStats stats;
+    stats.table = "SwissTable";
+    stats.histogramOf = "probe length";
+    stats.size = size;
+    stats.buckets = capacity;
+    stats.usedBuckets = size;
+    stats.bytes = sizeof(*this) + ctrl.capacity() + slots.capacity() * sizeof(Bid);
+
+    // how many groups a search for each stored bid reads
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++) {
+        if (ctrl[i] < 0) {
+            continue;
+        }
+        size_t pos = (hash(slots[i].bidId) >> 7) & mask;
+        size_t groups = 1;
+        for (size_t step = GROUP; ((i - pos) & mask) >= GROUP; step += GROUP) {
+            pos = (pos + step) & mask;
+            groups++;
+        }
+        stats.Count(groups);
+    }
+
+    stats.hits = hits;
+    stats.hitProbes = hitProbes;
+    stats.misses = misses;
+    stats.missProbes = missProbes;
+    return stats;
+}
+
+//============================================================================
+// Concurrent Hash Table class definition
+//============================================================================
+
+/**
+ * Define a hash table that many threads can use at once: any number of
+ * threads may Search while others Insert and Remove.
+ *
+ * The table is split into segments by the top bits of the hash, each a
+ * small linear-probing table with its own lock, so writers only wait for
+ * writers that hit the same segment. Readers take no lock at all. Each
+ * segment has a sequence number that writers make odd while they change
+ * the segment and even again when done; a reader notes the number, reads
+ * the slots, and starts over if the number changed meanwhile.
+ *
+ * Inserting a bid id that is already stored replaces that bid.
+ */
+template <typename KeyHash = MixHash>
+class ConcurrentHashTable {
+
+private:
+    static constexpr unsigned int SEGMENT_BITS = 6;
+    static constexpr unsigned int SEGMENTS = 1u << SEGMENT_BITS;
+    static constexpr size_t FIRST_CAPACITY = 16;
+
+    // A slot holds the fields of one bid; bidId 0 marks it empty. They
+    // are atomics only so a reader racing a writer is well defined, all
+    // accesses are relaxed and ordered by the sequence number. The mask
+    // and vector of a Slots are plain members, so the pointer to them is
+    // published with release and loaded with acquire instead.
+    struct Slot {
+        atomic<uint32_t> bidId;
+        atomic<uint32_t> title;
+        atomic<int64_t> cents;
+        atomic<uint16_t> fund;
+
+        Slot() {
+            bidId.store(0, memory_order_relaxed);
+            title.store(0, memory_order_relaxed);
+            cents.store(0, memory_order_relaxed);
+            fund.store(0, memory_order_relaxed);
+        }
+    };
+
+    // the slots of a segment and their count, swapped as one when it grows
+    struct Slots {
+        size_t mask;
+        vector<Slot> slot;
+
+        Slots(size_t capacity) : mask(capacity - 1), slot(capacity) {
+        }
+    };
+
+    struct alignas(64) Segment {
+        atomic<uint32_t> sequence;
+        atomic<Slots*> slots;
+        mutex lock;
+        size_t size = 0;
+        vector<Slots*> retired; // outgrown slots a reader may still be in
+    };
+
+    Segment segments[SEGMENTS];
+    atomic<size_t> size;
+
+    static void store(Slot& slot, const Bid& bid);
+    static void copy(Slot& to, const Slot& from);
+    Segment& segmentOf(uint64_t h);
+    void beginWrite(Segment& segment);
+    void endWrite(Segment& segment);
+    void grow(Segment& segment);
+
+public:
+    ConcurrentHashTable();
+    virtual ~ConcurrentHashTable();
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+    void Insert(Bid bid);
+    void PrintAll();
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
+    size_t Size();
+    TableStats Stats();
+};
+
+/**
+ * Default constructor
+ */
+template <typename KeyHash>
+ConcurrentHashTable<KeyHash>::ConcurrentHashTable() {
+    for (Segment& segment : segments) {
+        segment.sequence.store(0, memory_order_relaxed);
+        segment.slots.store(new Slots(FIRST_CAPACITY), memory_order_relaxed);
+    }
+    size.store(0, memory_order_relaxed);
+}
+
+/**
+ * Destructor
+ */
+template <typename KeyHash>
+ConcurrentHashTable<KeyHash>::~ConcurrentHashTable() {
+    for (Segment& segment : segments) {
+        delete segment.slots.load(memory_order_relaxed);
+        for (Slots* old : segment.retired) {
+            delete old;
+        }
+    }
+}
+
+/**
+ * Write a bid into a slot
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::store(Slot& slot, const Bid& bid) {
+    slot.bidId.store(bid.bidId, memory_order_relaxed);
+    slot.title.store(bid.title, memory_order_relaxed);
+    slot.cents.store(bid.cents, memory_order_relaxed);
+    slot.fund.store(bid.fund, memory_order_relaxed);
+}
+
+/**
+ * Copy one slot into another
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::copy(Slot& to, const Slot& from) {
+    to.bidId.store(from.bidId.load(memory_order_relaxed), memory_order_relaxed);
+    to.title.store(from.title.load(memory_order_relaxed), memory_order_relaxed);
+    to.cents.store(from.cents.load(memory_order_relaxed), memory_order_relaxed);
+    to.fund.store(from.fund.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+template <typename KeyHash>
+typename ConcurrentHashTable<KeyHash>::Segment& ConcurrentHashTable<KeyHash>::segmentOf(uint64_t h) {
+    return segments[h >> (64 - SEGMENT_BITS)];
+}
+
+/**
+ * Lock a segment and make its sequence number odd, which sends readers
+ * of the segment back to the start
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::beginWrite(Segment& segment) {
+    segment.lock.lock();
+    segment.sequence.store(segment.sequence.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * Make the sequence number even again, publishing the writes, and unlock
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::endWrite(Segment& segment) {
+    segment.sequence.store(segment.sequence.load(memory_order_relaxed) + 1, memory_order_release);
+    segment.lock.unlock();
+}
+
+/**
+ * Double the slots of a segment; called between beginWrite and endWrite.
+ * The old slots are kept until the table is destroyed because a reader
+ * may still be probing them.
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::grow(Segment& segment) {
+    Slots* old = segment.slots.load(memory_order_acquire);
+    Slots* slots = new Slots((old->mask + 1) * 2);
+
+    for (Slot& from : old->slot) {
+        uint32_t bidId = from.bidId.load(memory_order_relaxed);
+        if (bidId == 0) {
+            continue;
+        }
+        size_t pos = KeyHash::Hash(bidId) & slots->mask;
+        while (slots->slot[pos].bidId.load(memory_order_relaxed) != 0) {
+            pos = (pos + 1) & slots->mask;
+        }
+        copy(slots->slot[pos], from);
+    }
+
+    segment.slots.store(slots, memory_order_release);
+    segment.retired.push_back(old);
+}
+
+/**
+ * Insert a bid
+ *
+ * @param bid The bid to insert
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::Insert(Bid bid) {
+    if (bid.bidId == 0) {
+        return;
+    }
+
+    uint64_t h = KeyHash::Hash(bid.bidId);
+    Segment& segment = segmentOf(h);
+    beginWrite(segment);
+
+    // keep each segment at most 3/4 full so probes stay short
+    Slots* slots = segment.slots.load(memory_order_acquire);
+    if ((segment.size + 1) * 4 > (slots->mask + 1) * 3) {
+        grow(segment);
+        slots = segment.slots.load(memory_order_acquire);
+    }
+
+    size_t pos = h & slots->mask;
+    for (;;) {
+        uint32_t current = slots->slot[pos].bidId.load(memory_order_relaxed);
+        if (current == bid.bidId) {
+            break;
+        }
+        if (current == 0) {
+            segment.size++;
+            size.fetch_add(1, memory_order_relaxed);
+            break;
+        }
+        pos = (pos + 1) & slots->mask;
+    }
+    store(slots->slot[pos], bid);
+
+    endWrite(segment);
+}
+
+/**
+ * Print all bids, one segment at a time
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::PrintAll() {
+    for (Segment& segment : segments) {
+        lock_guard<mutex> lock(segment.lock);
+        Slots* slots = segment.slots.load(memory_order_acquire);
+
+        for (size_t i = 0; i <= slots->mask; i++) {
+            Slot& slot = slots->slot[i];
+            if (slot.bidId.load(memory_order_relaxed) == 0) {
+                continue;
+            }
+
+            Bid bid;
+            bid.bidId = slot.bidId.load(memory_order_relaxed);
+            bid.title = slot.title.load(memory_order_relaxed);
+            bid.cents = slot.cents.load(memory_order_relaxed);
+            bid.fund = slot.fund.load(memory_order_relaxed);
+
+            // output segment, bidID, title, amount and fund
+            cout << (&segment - segments) << ", ";
+            cout << bid.bidId << ", ";
+            cout << bid.Title() << ", ";
+            cout << bid.Amount() << ", ";
+            cout << bid.Fund() << endl;
+        }
+    }
+}
+
+/**
+ * Remove a bid
+ *
+ * @param bidId The bid id to remove
+ */
+template <typename KeyHash>
+void ConcurrentHashTable<KeyHash>::Remove(uint32_t bidId) {
+    uint64_t h = KeyHash::Hash(bidId);
+    Segment& segment = segmentOf(h);
+    beginWrite(segment);
+
+    Slots* slots = segment.slots.load(memory_order_acquire);
+    size_t mask = slots->mask;
+    size_t pos = h & mask;
+
+    while (bidId != 0 && slots->slot[pos].bidId.load(memory_order_relaxed) != bidId) {
+        if (slots->slot[pos].bidId.load(memory_order_relaxed) == 0) {
+            bidId = 0;
+            break;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    if (bidId != 0) {
+        // shift later bids of the same run back into the hole, so no
+        // probe ever needs a deleted marker to keep going
+        size_t hole = pos;
+        for (size_t next = (hole + 1) & mask; ; next = (next + 1) & mask) {
+            uint32_t moved = slots->slot[next].bidId.load(memory_order_relaxed);
+            if (moved == 0) {
+                break;
+            }
+            size_t home = KeyHash::Hash(moved) & mask;
+            // a bid may move back unless its home lies after the hole
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                copy(slots->slot[hole], slots->slot[next]);
+                hole = next;
+            }
+        }
+        store(slots->slot[hole], Bid());
+        segment.size--;
+        size.fetch_sub(1, memory_order_relaxed);
+    }
+
+    endWrite(segment);
+}
+
+/**
+ * Search for the specified bidId without taking a lock
+ *
+ * @param bidId The bid id to search for
+ */
+template <typename KeyHash>
+Bid ConcurrentHashTable<KeyHash>::Search(uint32_t bidId) {
+    Bid bid;
+    if (bidId == 0) {
+        return bid;
+    }
+
+    uint64_t h = KeyHash::Hash(bidId);
+    Segment& segment = segmentOf(h);
+
+    for (;;) {
+        uint32_t sequence = segment.sequence.load(memory_order_acquire);
+        if (sequence & 1) {
+            // a writer is in the segment
+            this_thread::yield();
+            continue;
+        }
+
+        Slots* slots = segment.slots.load(memory_order_acquire);
+        bid = Bid();
+
+        // at most every slot, in case a writer tore the run being read
+        size_t pos = h & slots->mask;
+        for (size_t probes = 0; probes <= slots->mask; probes++) {
+            const Slot& slot = slots->slot[pos];
+            uint32_t current = slot.bidId.load(memory_order_relaxed);
+            if (current == bidId) {
+                bid.bidId = current;
+                bid.title = slot.title.load(memory_order_relaxed);
+                bid.cents = slot.cents.load(memory_order_relaxed);
+                bid.fund = slot.fund.load(memory_order_relaxed);
+                break;
+            }
+            if (current == 0) {
+                break;
+            }
+            pos = (pos + 1) & slots->mask;
+        }
+
+        // keep the result only if no writer came by meanwhile
+        atomic_thread_fence(memory_order_acquire);
+        if (segment.sequence.load(memory_order_relaxed) == sequence) {
+            return bid;
+        }
+    }
+}
+
+/**
+ * Returns the number of bids in the table
+ */
+template <typename KeyHash>
+size_t ConcurrentHashTable<KeyHash>::Size() {
+    return size.load(memory_order_relaxed);
+}
+
+/**
+ * Returns the layout of the table. Search keeps no counters, readers
+ * would all be writing the same cache lines, so those stay zero.
+ */
+template <typename KeyHash>
+TableStats ConcurrentHashTable<KeyHash>::Stats() {
+    TableStats stats;
+    stats.table = "ConcurrentHashTable";
+    stats.histogramOf = "probe length";
+    stats.bytes = sizeof(*this);
+
+    for (Segment& segment : segments) {
+        lock_guard<mutex> lock(segment.lock);
+        Slots* slots = segment.slots.load(memory_order_acquire);
+
+        stats.size += segment.size;
+        stats.buckets += slots->mask + 1;
+        stats.usedBuckets += segment.size;
+        stats.bytes += sizeof(Slots) + slots->slot.capacity() * sizeof(Slot);
+        for (Slots* old : segment.retired) {
+            stats.bytes += sizeof(Slots) + old->slot.capacity() * sizeof(Slot);
+        }
+
+        // slots read to find each bid, its home slot included
+        for (size_t i = 0; i <= slots->mask; i++) {
+            uint32_t bidId = slots->slot[i].bidId.load(memory_order_relaxed);
+            if (bidId != 0) {
+                stats.Count(((i - KeyHash::Hash(bidId)) & slots->mask) + 1);
+            }
+        }
+    }
+    return stats;
+}
+
+/**
+ * Freeze the bids into a table with a minimal perfect hash
+ *
+ * @return The new table, which the caller deletes
+ */
+template <typename KeyHash>
+FrozenTable* HashTable<KeyHash>::Freeze() {
+    vector<Bid> bids;
+    bids.reserve(size);
+
+    // buckets not yet moved by a rehash, then the current ones; each
+    // chain in order, so the bid Search finds comes first
+    for (vector<Node>* table : { &oldNodes, &nodes }) {
+        size_t first = table == &oldNodes ? migrated : 0;
+        for (size_t i = first; i < table->size(); i++) {
+            if ((*table)[i].key == UINT_MAX) {
+                continue;
+            }
+            bids.push_back((*table)[i].bid);
+            for (Node* current = (*table)[i].next; current != nullptr; current = current->next) {
+                bids.push_back(current->bid);
+            }
+        }
+    }
+    return new FrozenTable(bids);
+}
+
+//============================================================================
+// Static methods used for testing
+//============================================================================
+
+/**
+ * Display the bid information to the console (std::out)
+ *
+ * @param bid struct containing the bid info
+ */
+void displayBid(Bid bid) {
+    cout << bid.bidId << ": " << bid.Title() << " | " << bid.Amount() << " | "
+            << bid.Fund() << endl;
+    return;
+}
+
+/**
+ * Display a bid read in place from a frozen table
+ *
+ * @param bid struct containing the bid info
+ */
+void displayBid(const ParsedBid& bid) {
+    cout << bid.bidId << ": " << bid.title << " | " << bid.cents / 100.0 << " | "
+            << bid.fund << endl;
+}
+
+/**
+ * Rebuild a bid from one entry of a compiled snapshot
+ *
+ * @param snapshot The mapped snapshot
+ * @param i Position of the bid in the snapshot
+ * @return Bid struct containing the bid info
+ */
+Bid snapshotBid(const BidSnapshot& snapshot, size_t i) {
+    return Bid(snapshot.BidId(i), snapshot.Title(i), snapshot.Fund(i), snapshot.Cents(i));
+}
+
+/**
+ * Insert a batch of loaded bids into a table one at a time
+ *
+ * @param table the table to insert the bids into
+ * @param bids the bids to insert
+ */
+template <typename Table>
+void insertBids(Table* table, const vector<Bid>& bids) {
+    for (const Bid& bid : bids) {
+        table->Insert(bid);
+    }
+}
+
+/**
+ * Insert loaded bids into a HashTable, which builds itself on every core
+ */
+template <typename KeyHash>
+void insertBids(HashTable<KeyHash>* table, const vector<Bid>& bids) {
+    table->InsertBatch(bids, max(1u, thread::hardware_concurrency()));
+}
+
+/**
+ * Keep loaded bids as they are, for drivers that insert them themselves
+ */
+void insertBids(vector<Bid>* collected, const vector<Bid>& bids) {
+    collected->insert(collected->end(), bids.begin(), bids.end());
+}
+
+/**
+ * Parse the rows of a CSV file into bids, handing each one to store in
+ * file order. The file is mapped and parsed on every core; a file that
+ * can't be mapped, such as a pipe, is read through a fixed buffer on
+ * this thread instead.
+ *
+ * @param csvPath the path to the CSV file to read
+ * @param store called with each parsed bid
+ */
+template <typename Store>
+void readBids(const string& csvPath, Store store) {
+    // only split out the four columns a bid is built from, by position
+    // since the monthly exports don't agree on the header names
+    const vector<unsigned int> columns = { 1, 0, 8, 4 };
+
+    // parse the numbers here, the strings are interned by store
+    auto parse = [](const csv::RowView &row) {
+        ParsedBid parsed;
+        parseBidId(row[0], parsed.bidId);
+        parsed.title = row[1];
+        parsed.fund = row[2];
+
+        // the amount is decoded as exact cents, "$1,125.00 " included
+        csv::parseCents(row[3], parsed.cents);
+
+        return parsed;
+    };
+
+    // read and display header row - optional
+    auto showHeader = [](const vector<string>& header) {
+        for (auto const& c : header) {
+            cout << c << " | ";
+        }
+        cout << "" << endl;
+    };
+
+    // parse on every core, bids still arrive one at a time in file order
+    unsigned int threads = max(1u, thread::hardware_concurrency());
+
+    bool mapped = false;
+    try {
+        // map the CSV file and index its rows in parallel
+        csv::MappedParser file(csvPath, ',', threads);
+        mapped = true;
+        file.project(columns);
+        showHeader(file.getHeader());
+
+        file.forEachRow(parse, store, threads);
+        return;
+    } catch (csv::Error &e) {
+        if (mapped) {
+            throw;
+        }
+    }
+
+    // stream it instead; a missing file fails here too
+    csv::Reader file(csvPath);
+    file.project(columns);
+    showHeader(file.getHeader());
+
+    file.forEachRow([&](const csv::RowView &row) {
+        ParsedBid parsed = parse(row);
+        store(parsed);
+    });
+}
+
+/**
+ * Load a CSV file containing bids into a container
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param hashTable the HashTable or SwissTable to insert the bids into
+ */
+template <typename Table>
+void loadBids(string csvPath, Table* hashTable) {
+    // a current snapshot compiled from this CSV skips parsing altogether
+    string snapshotPath = csvPath + ".snap";
+
+    // bids go into the table as they arrive, LOAD_BATCH at a time
+    vector<Bid> batch;
+    batch.reserve(LOAD_BATCH);
+    auto add = [&](const Bid& bid) {
+        batch.push_back(bid);
+        if (batch.size() == LOAD_BATCH) {
+            insertBids(hashTable, batch);
+            batch.clear();
+        }
+    };
+
+    try {
+        BidSnapshot snapshot(snapshotPath, csvPath);
+
+        cout << "Loading snapshot " << snapshotPath << endl;
+        for (size_t i = 0; i < snapshot.Size(); i++) {
+            add(snapshotBid(snapshot, i));
+        }
+        insertBids(hashTable, batch);
+        return;
+    } catch (SnapshotError &e) {
+        // missing or out of date, read the CSV instead
+    }
+
+    cout << "Loading CSV file " << csvPath << endl;
+
+    // the bids read are compiled into a snapshot for the next load
+    BidSnapshotWriter compiled;
+    unsigned int skipped = 0;
+
+    try {
+        // each bid arrives here, one at a time in file order
+        readBids(csvPath, [&](ParsedBid &parsed) {
+            // rows without a numeric auction id can't be stored
+            if (parsed.bidId == 0) {
+                skipped++;
+                return;
+            }
+
+            // initialize a bid using data from the current row
+            Bid bid(parsed.bidId, parsed.title, parsed.fund, parsed.cents);
+
+            // push this bid to the end
+            add(bid);
+            compiled.Add(bid.bidId, bid.cents, parsed.title, parsed.fund);
+        });
+
+        compiled.Write(snapshotPath, csvPath);
+    } catch (SnapshotError &e) {
+        std::cerr << e.what() << std::endl;
+    } catch (csv::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+
+    // reported even when a damaged file stopped the load part way
+    if (skipped > 0) {
+        cout << skipped << " rows skipped, auction id is missing or not a 32-bit number" << endl;
+    }
+
+    // the bids read before any error are kept
+    insertBids(hashTable, batch);
+}
+
+/**
+ * Run the interactive menu against one kind of table
+ *
+ * @param bidTable the table to keep the bids in
+ * @param csvPath the CSV file to load bids from
+ * @param bidKey the bid Id to use when searching the table
+ */
+template <typename Table>
+void runMenu(Table* bidTable, const string& csvPath, const string& bidKey) {
+    // auction ids are numeric, so the key is parsed once up front
+    uint32_t bidId = 0;
+    parseBidId(bidKey, bidId);
+
+    // Define a timer variable
+    clock_t ticks;
+
+    Bid bid;
+
+    int choice = 0;
+    while (choice != 9) {
+        cout << "Menu:" << endl;
+        cout << "  1. Load Bids" << endl;
+        cout << "  2. Display All Bids" << endl;
+        cout << "  3. Find Bid" << endl;
+        cout << "  4. Remove Bid" << endl;
+        cout << "  5. Display Statistics" << endl;
+        cout << "  6. Display Statistics as JSON" << endl;
+        cout << "  9. Exit" << endl;
+        cout << "Enter choice: ";
+        cin >> choice;
+
+        switch (choice) {
+
+        case 1:
+            
+            // Initialize a timer variable before loading bids
+            ticks = clock();
+
+            // Complete the method call to load the bids
+            loadBids(csvPath, bidTable);
+
+            // Calculate elapsed time and display result
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 2:
+            bidTable->PrintAll();
+            break;
+
+        case 3:
+            ticks = clock();
+
+            bid = bidTable->Search(bidId);
+
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+            if (bid.bidId != 0) {
+                displayBid(bid);
+            } else {
+                cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 4:
+            bidTable->Remove(bidId);
+            break;
+
+        case 5:
+            cout << bidTable->Stats().Text();
+            break;
+
+        case 6:
+            cout << bidTable->Stats().Json() << endl;
+            break;
+        }
+    }
+
+}
+
+/**
+ * Look the bid up in a frozen table, mapping a saved one when it is
+ * current and otherwise freezing the bids of the CSV and saving them
+ *
+ * @param csvPath the CSV file the bids come from
+ * @param bidKey the bid Id to search for
+ */
+void runFrozen(const string& csvPath, const string& bidKey) {
+    uint32_t bidId = 0;
+    parseBidId(bidKey, bidId);
+
+    string frozenPath = csvPath + ".mph";
+    FrozenTable* bidTable;
+
+    clock_t ticks = clock();
+    try {
+        bidTable = new FrozenTable(frozenPath, csvPath);
+        cout << "Loading frozen table " << frozenPath << endl;
+    } catch (FrozenError &e) {
+        // missing or out of date, freeze the bids again
+        HashTable<> loaded;
+        loadBids(csvPath, &loaded);
+        bidTable = loaded.Freeze();
+        try {
+            bidTable->Save(frozenPath, csvPath);
+        } catch (FrozenError &e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    ticks = clock() - ticks;
+    cout << bidTable->Size() << " bids frozen" << endl;
+    cout << "time: " << ticks << " clock ticks" << endl;
+    cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+    ticks = clock();
+    ParsedBid bid = bidTable->Search(bidId);
+    ticks = clock() - ticks;
+
+    if (bid.bidId != 0) {
+        displayBid(bid);
+    } else {
+        cout << "Bid Id " << bidKey << " not found." << endl;
+    }
+    cout << "time: " << ticks << " clock ticks" << endl;
+    cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+    delete bidTable;
+}
+
+/**
+ * Search a ConcurrentHashTable from more and more reader threads while
+ * one writer keeps removing and inserting the bids of the CSV, and show
+ * how many searches and writes each round completes. A search that finds
+ * a bid other than the one stored under its id is counted as wrong.
+ *
+ * @param csvPath the CSV file the bids come from
+ */
+void runReaders(const string& csvPath) {
+    vector<Bid> bids;
+    loadBids(csvPath, &bids);
+
+    // a later row with the same id replaces an earlier one, keep the last
+    // so every search knows the bid it should find
+    stable_sort(bids.begin(), bids.end(), [](const Bid& a, const Bid& b) {
+        return a.bidId < b.bidId;
+    });
+    vector<Bid> stored;
+    for (size_t i = 0; i < bids.size(); i++) {
+        if (i + 1 == bids.size() || bids[i + 1].bidId != bids[i].bidId) {
+            stored.push_back(bids[i]);
+        }
+    }
+    if (stored.empty()) {
+        cout << "No bids to search." << endl;
+        return;
+    }
+
+    // up to one reader per core, and at least four so a small machine
+    // still sees readers racing the writer and each other
+    unsigned int most = max(4u, thread::hardware_concurrency());
+    for (unsigned int readers = 1; readers <= most; readers *= 2) {
+        ConcurrentHashTable<> table;
+        insertBids(&table, stored);
+
+        atomic<bool> stop(false);
+        atomic<uint64_t> searches(0);
+        atomic<uint64_t> wrong(0);
+        uint64_t writes = 0;
+
+        // take every bid out and put it back, so all segments keep changing
+        thread writer([&]() {
+            while (!stop.load(memory_order_relaxed)) {
+                for (size_t i = 0; i < stored.size() && !stop.load(memory_order_relaxed); i++) {
+                    table.Remove(stored[i].bidId);
+                    table.Insert(stored[i]);
+                    writes += 2;
+                }
+            }
+        });
+
+        auto reader = [&](uint64_t seed) {
+            uint64_t done = 0;
+            uint64_t bad = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                // xorshift, so readers don't share a generator
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                const Bid& expected = stored[seed % stored.size()];
+
+                // the writer may have the bid out, but never half written
+                Bid found = table.Search(expected.bidId);
+                if (found.bidId != 0 && (found.bidId != expected.bidId || found.title != expected.title
+                        || found.cents != expected.cents || found.fund != expected.fund)) {
+                    bad++;
+                }
+                done++;
+            }
+            searches.fetch_add(done);
+            wrong.fetch_add(bad);
+        };
+
+        vector<thread> pool;
+        for (unsigned int r = 0; r < readers; r++) {
+            pool.push_back(thread(reader, 0x9E3779B97F4A7C15ull * (r + 1)));
+        }
+        this_thread::sleep_for(chrono::milliseconds(READER_ROUND_MS));
+        stop.store(true);
+        for (thread& worker : pool) {
+            worker.join();
+        }
+        writer.join();
+
+        cout << readers << " readers: ";
+        cout << searches.load() * 1000 / READER_ROUND_MS << " searches per second, ";
+        cout << writes * 1000 / READER_ROUND_MS << " writes per second, ";
+        cout << wrong.load() << " wrong" << endl;
+    }
+}
+
+/**
+ * The one and only main() method
+ *
+ * @param arg[1] path to CSV file to load from (optional)
+ * @param arg[2] the bid Id to use when searching the table (optional)
+ * @param arg[3] "swiss" to keep the bids in a SwissTable, "concurrent"
+ *        for a ConcurrentHashTable, "readers" to search one from more
+ *        and more threads while it is written, "incremental" for a
+ *        HashTable that rehashes incrementally, "filtered" for a HashTable
+ *        with a Bloom filter in front of Search, or "frozen" to look the
+ *        bid up once in a FrozenTable (optional)
+ */
+int main(int argc, char* argv[]) {
+
+    // process command line arguments
+    string csvPath, bidKey, tableType;
+    switch (argc) {
+    case 2:
+        csvPath = argv[1];
+        bidKey = "98223";
+        break;
+    case 3:
+        csvPath = argv[1];
+        bidKey = argv[2];
+        break;
+    case 4:
+        csvPath = argv[1];
+        bidKey = argv[2];
+        tableType = argv[3];
+        break;
+    default:
+        csvPath = "eBid_Monthly_Sales.csv";
+        bidKey = "98223";
+    }
+
+    if (tableType == "swiss") {
+        SwissTable<> bidTable;
+        runMenu(&bidTable, csvPath, bidKey);
+    } else if (tableType == "concurrent") {
+        ConcurrentHashTable<> bidTable;
+        runMenu(&bidTable, csvPath, bidKey);
+    } else if (tableType == "readers") {
+        runReaders(csvPath);
+    } else if (tableType == "frozen") {
+        runFrozen(csvPath, bidKey);
+    } else {
+        HashTable<> bidTable;
+        bidTable.SetIncrementalRehash(tableType == "incremental");
+        if (tableType == "filtered") {
+            bidTable.SetFilter(DEFAULT_FALSE_POSITIVE_RATE, 0);
         }
+        runMenu(&bidTable, csvPath, bidKey);
     }
 
     cout << "Good bye." << endl;
@@ -0,0 +1,196 @@
+//============================================================================
+// Name        : Bid.cpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Compact bid record shared by the bid containers
+//============================================================================
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "Bid.hpp"
+#include "CSVparser.hpp"
+
+using namespace std;
+
+//============================================================================
+// Title arena
+//============================================================================
+
+/**
+ * Default constructor, handle 0 is the empty title
+ */
+TitleArena::TitleArena() {
+    chunks[0].reset(new char[CHUNK_SIZE]);
+    chunks[0][0] = '\0';
+    chunkCount = 1;
+    used = 1;
+    bytes = 1;
+}
+
+/**
+ * Look a title up, copying it into the arena the first time it is seen
+ *
+ * @param title The title to store
+ * @return The handle of the stored title
+ */
+uint32_t TitleArena::Intern(string_view title) {
+    if (title.empty()) {
+        return 0;
+    }
+    lock_guard<mutex> guard(lock);
+    unordered_map<string_view, uint32_t>::const_iterator it = index.find(title);
+    if (it != index.end()) {
+        return it->second;
+    }
+
+    // start a new chunk when this one is full; a title longer than a
+    // chunk gets one of its own size
+    size_t need = title.size() + 1;
+    if (used + need > CHUNK_SIZE) {
+        if (chunkCount == MAX_CHUNKS) {
+            throw length_error("title arena is full");
+        }
+        chunks[chunkCount++].reset(new char[max(need, CHUNK_SIZE)]);
+        used = 0;
+    }
+
+    char* text = chunks[chunkCount - 1].get() + used;
+    memcpy(text, title.data(), title.size());
+    text[title.size()] = '\0';
+
+    uint32_t handle = static_cast<uint32_t>(((chunkCount - 1) << CHUNK_BITS) | used);
+    used = need > CHUNK_SIZE ? CHUNK_SIZE : used + need;
+    bytes += need;
+    index.emplace(string_view(text, title.size()), handle);
+    return handle;
+}
+
+/**
+ * Returns the title stored at a handle
+ */
+string_view TitleArena::Get(uint32_t handle) const {
+    return string_view(chunks[handle >> CHUNK_BITS].get() + (handle & (CHUNK_SIZE - 1)));
+}
+
+/**
+ * Returns the number of bytes used by all titles
+ */
+size_t TitleArena::Bytes() const {
+    lock_guard<mutex> guard(lock);
+    return bytes;
+}
+
+//============================================================================
+// Fund dictionary
+//============================================================================
+
+/**
+ * Default constructor, id 0 is the empty fund
+ */
+FundDictionary::FundDictionary() {
+    blocks[0].reset(new string[BLOCK_SIZE]);
+    count = 1;
+    ids.emplace(blocks[0][0], 0);
+}
+
+/**
+ * Look a fund name up, adding it the first time it is seen
+ *
+ * @param fund The fund name
+ * @return The id of the fund
+ */
+uint16_t FundDictionary::Intern(string_view fund) {
+    lock_guard<mutex> guard(lock);
+    unordered_map<string_view, uint16_t>::const_iterator it = ids.find(fund);
+
+    if (it != ids.end()) {
+        return it->second;
+    }
+    if (count > numeric_limits<uint16_t>::max()) {
+        throw length_error("too many funds");
+    }
+
+    uint16_t id = static_cast<uint16_t>(count++);
+    if ((id & (BLOCK_SIZE - 1)) == 0) {
+        blocks[id >> BLOCK_BITS].reset(new string[BLOCK_SIZE]);
+    }
+    string& name = blocks[id >> BLOCK_BITS][id & (BLOCK_SIZE - 1)];
+    name.assign(fund);
+    ids.emplace(name, id);
+    return id;
+}
+
+/**
+ * Returns the fund name for an id
+ */
+const string& FundDictionary::Get(uint16_t id) const {
+    return blocks[id >> BLOCK_BITS][id & (BLOCK_SIZE - 1)];
+}
+
+/**
+ * Returns the number of distinct funds, the empty one included
+ */
+size_t FundDictionary::Size() const {
+    lock_guard<mutex> guard(lock);
+    return count;
+}
+
+TitleArena& titleArena() {
+    static TitleArena arena;
+    return arena;
+}
+
+FundDictionary& fundDictionary() {
+    static FundDictionary dictionary;
+    return dictionary;
+}
+
+//============================================================================
+// Bid record
+//============================================================================
+
+/**
+ * Initialize a bid, interning its title and fund
+ */
+Bid::Bid(uint32_t aBidId, string_view aTitle, string_view aFund, int64_t aCents) {
+    cents = aCents;
+    bidId = aBidId;
+    title = titleArena().Intern(aTitle);
+    fund = fundDictionary().Intern(aFund);
+}
+
+string_view Bid::Title() const {
+    return titleArena().Get(title);
+}
+
+const string& Bid::Fund() const {
+    return fundDictionary().Get(fund);
+}
+
+/**
+ * Returns the winning bid in dollars, for display
+ */
+double Bid::Amount() const {
+    return cents / 100.0;
+}
+
+/**
+ * Read an auction id
+ *
+ * @param text The id as typed or read from a file
+ * @param bidId Set to the id
+ * @return false if the text is not an id that fits in 32 bits
+ */
+bool parseBidId(string_view text, uint32_t& bidId) {
+    unsigned long long value;
+
+    if (!csv::parseInteger(text, value) || value == 0 || value > numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    bidId = static_cast<uint32_t>(value);
+    return true;
+}
@@ -0,0 +1,138 @@
+//============================================================================
+// Name        : BidSnapshot.hpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Columnar binary snapshot of eBid data
+//============================================================================
+
+#ifndef BIDSNAPSHOT_HPP
+#define BIDSNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "CSVparser.hpp"
+
+/**
+ * Thrown when a snapshot cannot be written, or is missing, out of date
+ * or damaged when it is read back
+ */
+class SnapshotError : public std::runtime_error {
+public:
+    SnapshotError(const std::string& msg) :
+            std::runtime_error(std::string("BidSnapshot : ").append(msg)) {
+    }
+};
+
+/**
+ * Fixed header at the start of every snapshot file.
+ *
+ * The file is little-endian and every section starts on an 8 byte
+ * boundary, so the columns can be read in place from a mapping:
+ *
+ *   header | ids uint32[n] | cents int64[n]
+ *          | title offsets uint32[n + 1] | title bytes
+ *          | fund offsets uint32[n + 1]  | fund bytes
+ *
+ * String i of a heap is bytes [offsets[i], offsets[i + 1]).
+ */
+struct SnapshotHeader {
+    char magic[8];              // "EBIDSNAP"
+    uint32_t version;           // SNAPSHOT_VERSION
+    uint32_t count;             // number of bids
+    uint64_t sourceSize;        // size of the CSV the snapshot was compiled from
+    int64_t sourceTime;         // last write time of that CSV
+    uint64_t idsOffset;
+    uint64_t centsOffset;
+    uint64_t titleIndexOffset;
+    uint64_t titleHeapOffset;
+    uint64_t fundIndexOffset;
+    uint64_t fundHeapOffset;
+    uint64_t fileSize;
+    uint64_t checksum;          // over every byte after the header
+};
+
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint64_t CHECKSUM_SEED = 14695981039346656037ULL;
+
+// shared with the other file formats that are mapped in place
+uint64_t align8(uint64_t offset);
+uint64_t checksum(const char* data, size_t size, uint64_t hash = CHECKSUM_SEED);
+bool sourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time);
+bool sectionFits(uint64_t begin, uint64_t end, uint64_t count, uint64_t width);
+
+//============================================================================
+// Snapshot writer definition
+//============================================================================
+
+/**
+ * Compiles bids into a snapshot as they are parsed. This is the
+ * "compile" step, run once while a CSV is read. Each column goes to a
+ * temporary file of its own as bids are added, so memory use does not
+ * grow with the number of bids; Write then copies the columns one after
+ * the other into the snapshot.
+ */
+class BidSnapshotWriter {
+
+private:
+    std::FILE* ids;
+    std::FILE* cents;
+    std::FILE* titleOffsets;        // end of each title, the leading 0 is left out
+    std::FILE* titles;
+    std::FILE* fundOffsets;
+    std::FILE* funds;
+    size_t count;
+    uint64_t titleBytes;
+    uint64_t fundBytes;
+    bool complete;                  // false once a bid could not be kept
+
+public:
+    BidSnapshotWriter();
+    virtual ~BidSnapshotWriter();
+    BidSnapshotWriter(const BidSnapshotWriter&) = delete;
+    BidSnapshotWriter& operator=(const BidSnapshotWriter&) = delete;
+    bool Add(uint32_t bidId, int64_t amountCents, std::string_view title, std::string_view fund);
+    void Write(const std::string& path, const std::string& sourcePath);
+    size_t Size() const;
+};
+
+//============================================================================
+// Snapshot reader definition
+//============================================================================
+
+/**
+ * A snapshot mapped straight into memory. Opening one only checks the
+ * header and checksum; the columns are read in place from the mapping.
+ */
+class BidSnapshot {
+
+private:
+    csv::MappedFile* file;
+    const SnapshotHeader* header;
+    const uint32_t* ids;
+    const int64_t* cents;
+    const uint32_t* titleOffsets;
+    const char* titles;
+    const uint32_t* fundOffsets;
+    const char* funds;
+
+    void validate(const std::string& sourcePath);
+
+public:
+    BidSnapshot(const std::string& path, const std::string& sourcePath);
+    virtual ~BidSnapshot();
+    BidSnapshot(const BidSnapshot&) = delete;
+    BidSnapshot& operator=(const BidSnapshot&) = delete;
+    size_t Size() const;
+    uint32_t BidId(size_t i) const;
+    int64_t Cents(size_t i) const;
+    std::string_view Title(size_t i) const;
+    std::string_view Fund(size_t i) const;
+};
+
+#endif // BIDSNAPSHOT_HPP
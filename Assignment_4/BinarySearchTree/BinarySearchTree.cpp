@@ -6,10 +6,15 @@
 // Description : Lab 5-2 Binary Search Tree
 //============================================================================
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 #include <time.h>
 #include <functional>
 
+#include "Bid.hpp"
+#include "BidSnapshot.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
 
 using namespace std;
@@ -18,19 +23,11 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
-// forward declarations
-double strToDouble(string str, char ch);
-
-// define a structure to hold bid information
-struct Bid {
-    string bidId; // unique identifier
-    string title;
-    string fund;
-    double amount;
-    Bid() {
-        amount = 0.0;
-    }
-};
+// share of searches for absent ids a filtered tree lets through
+const double DEFAULT_FALSE_POSITIVE_RATE = 0.01;
+
+// ids a new filter is sized for before it first grows
+const size_t DEFAULT_FILTER_CAPACITY = 1024;
 
 // Internal structure for tree node
 struct Node {
@@ -64,11 +61,17 @@ class BinarySearchTree {
 private:
     Node* root;
 
+    // answers most searches for absent ids, nullptr when not used
+    BloomFilter* filter;
+
     void addNode(Node* node, Bid bid);
     void inOrder(Node* node);
     void postOrder(Node* node);
     void preOrder(Node* node);
-    Node* removeNode(Node* node, string bidId);
+    Node* removeNode(Node* node, uint32_t bidId);
+    size_t countNodes(Node* node);
+    void addToFilter(Node* node);
+    void fillFilter(size_t capacity);
 
 public:
     BinarySearchTree();
@@ -77,8 +80,10 @@ public:
     void PostOrder();
     void PreOrder();
     void Insert(Bid bid);
-    void Remove(string bidId);
-    Bid Search(string bidId);
+    void Remove(uint32_t bidId);
+    Bid Search(uint32_t bidId);
+    void SetFilter(double falsePositiveRate, size_t maxBytes);
+    void PrintFilter();
 };
 
 /**
@@ -89,6 +94,7 @@ BinarySearchTree::BinarySearchTree() {
      
     //root is equal to nullptr
     root = nullptr;
+    filter = nullptr;
 }
 
 /**
@@ -109,6 +115,7 @@ BinarySearchTree::~BinarySearchTree() {
     deleteRecursively(root);
 
     root = nullptr;
+    delete filter;
 }
 
 /**
@@ -158,12 +165,19 @@ void BinarySearchTree::Insert(Bid bid) {
         addNode(root, bid);
 
     }
+
+    if (filter != nullptr) {
+        filter->Add(bid.bidId);
+        if (filter->Full()) {
+            fillFilter(filter->Capacity() * 2);
+        }
+    }
 }
 
 /**
  * Remove a bid
  */
-void BinarySearchTree::Remove(string bidId) {
+void BinarySearchTree::Remove(uint32_t bidId) {
     // FIXME (7a) Implement removing a bid from the tree
     // remove node root bidID
     removeNode(root, bidId);
@@ -172,8 +186,13 @@ void BinarySearchTree::Remove(string bidId) {
 /**
  * Search for a bid
  */
-Bid BinarySearchTree::Search(string bidId) {
+Bid BinarySearchTree::Search(uint32_t bidId) {
     // FIXME (8) Implement searching the tree for a bid
+    // most ids that were never added stop at the filter
+    if (filter != nullptr && !filter->MayContain(bidId)) {
+        return Bid();
+    }
+
     // set current node equal to root
     Node* current = root;
 
@@ -193,10 +212,38 @@ Bid BinarySearchTree::Search(string bidId) {
             current = current->right;
         }
     }
+    if (filter != nullptr) {
+        filter->CountFalsePositive();
+    }
     Bid bid;
     return bid;
 }
 
+/**
+ * Put a Bloom filter in front of Search, so most searches for ids that
+ * were never added return without walking the tree. Removed ids stay
+ * in the filter until it fills up and is rebuilt from the tree.
+ *
+ * @param falsePositiveRate The share of absent ids let through
+ * @param maxBytes Most memory the filter may use, 0 for no limit
+ */
+void BinarySearchTree::SetFilter(double falsePositiveRate, size_t maxBytes) {
+    delete filter;
+    filter = new BloomFilter(DEFAULT_FILTER_CAPACITY, falsePositiveRate, maxBytes);
+    fillFilter(max(countNodes(root), DEFAULT_FILTER_CAPACITY));
+}
+
+/**
+ * Print the size and counters of the filter
+ */
+void BinarySearchTree::PrintFilter() {
+    if (filter == nullptr) {
+        cout << "No filter in front of Search" << endl;
+        return;
+    }
+    cout << filter->Text();
+}
+
 /**
  * Add a bid to some node (recursive)
  *
@@ -240,9 +287,9 @@ void BinarySearchTree::inOrder(Node* node) {
       inOrder(node->left);
       //output bidID, title, amount, fund
       cout << node->bid.bidId << " | " 
-          << node->bid.title << " | "
-          << node->bid.amount << " | "
-          << node->bid.fund << endl;
+          << node->bid.Title() << " | "
+          << node->bid.Amount() << " | "
+          << node->bid.Fund() << endl;
       //InOrder right
       inOrder(node->right);
 }
@@ -258,9 +305,9 @@ void BinarySearchTree::postOrder(Node* node) {
       postOrder(node->right);
       //output bidID, title, amount, fund
       cout << node->bid.bidId << " | "
-          << node->bid.title << " | "
-          << node->bid.amount << " | "
-          << node->bid.fund << endl;
+          << node->bid.Title() << " | "
+          << node->bid.Amount() << " | "
+          << node->bid.Fund() << endl;
 }
 
 void BinarySearchTree::preOrder(Node* node) {
@@ -271,19 +318,50 @@ void BinarySearchTree::preOrder(Node* node) {
       }
       //output bidID, title, amount, fund
       cout << node->bid.bidId << " | "
-          << node->bid.title << " | "
-          << node->bid.amount << " | "
-          << node->bid.fund << endl;
+          << node->bid.Title() << " | "
+          << node->bid.Amount() << " | "
+          << node->bid.Fund() << endl;
       //preOrder left
       preOrder(node->left);
       //preOrder right    
       preOrder(node->right);
 }
 
+/**
+ * Count the nodes under some node (recursive)
+ */
+size_t BinarySearchTree::countNodes(Node* node) {
+    if (node == nullptr) {
+        return 0;
+    }
+    return 1 + countNodes(node->left) + countNodes(node->right);
+}
+
+/**
+ * Add the ids under some node to the filter (recursive)
+ */
+void BinarySearchTree::addToFilter(Node* node) {
+    if (node == nullptr) {
+        return;
+    }
+    filter->Add(node->bid.bidId);
+    addToFilter(node->left);
+    addToFilter(node->right);
+}
+
+/**
+ * Clear the filter, size it for a number of bids and add every bid in
+ * the tree
+ */
+void BinarySearchTree::fillFilter(size_t capacity) {
+    filter->Reset(capacity);
+    addToFilter(root);
+}
+
 /**
  * Remove a bid from some node (recursive)
  */
-Node* BinarySearchTree::removeNode(Node* node, string bidId) {
+Node* BinarySearchTree::removeNode(Node* node, uint32_t bidId) {
     // FIXME (7b) Implement removing a bid from the tree
     // if node = nullptr return node
     if (node == nullptr) {
@@ -358,11 +436,88 @@ Node* BinarySearchTree::removeNode(Node* node, string bidId) {
  * @param bid struct containing the bid info
  */
 void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-            << bid.fund << endl;
+    cout << bid.bidId << ": " << bid.Title() << " | " << bid.Amount() << " | "
+            << bid.Fund() << endl;
     return;
 }
 
+/**
+ * Rebuild a bid from one entry of a compiled snapshot
+ *
+ * @param snapshot The mapped snapshot
+ * @param i Position of the bid in the snapshot
+ * @return Bid struct containing the bid info
+ */
+Bid snapshotBid(const BidSnapshot& snapshot, size_t i) {
+    return Bid(snapshot.BidId(i), snapshot.Title(i), snapshot.Fund(i), snapshot.Cents(i));
+}
+
+/**
+ * Parse the rows of a CSV file into bids, handing each one to store in
+ * file order. The file is mapped and parsed on every core; a file that
+ * can't be mapped, such as a pipe, is read through a fixed buffer on
+ * this thread instead.
+ *
+ * @param csvPath the path to the CSV file to read
+ * @param store called with each parsed bid
+ */
+template <typename Store>
+void readBids(const string& csvPath, Store store) {
+    // only split out the four columns a bid is built from, by position
+    // since the monthly exports don't agree on the header names
+    const vector<unsigned int> columns = { 1, 0, 8, 4 };
+
+    // parse the numbers here, the strings are interned by store
+    auto parse = [](const csv::RowView &row) {
+        ParsedBid parsed;
+        parseBidId(row[0], parsed.bidId);
+        parsed.title = row[1];
+        parsed.fund = row[2];
+
+        // the amount is decoded as exact cents, "$1,125.00 " included
+        csv::parseCents(row[3], parsed.cents);
+
+        return parsed;
+    };
+
+    // read and display header row - optional
+    auto showHeader = [](const vector<string>& header) {
+        for (auto const& c : header) {
+            cout << c << " | ";
+        }
+        cout << "" << endl;
+    };
+
+    // parse on every core, bids still arrive one at a time in file order
+    unsigned int threads = max(1u, thread::hardware_concurrency());
+
+    bool mapped = false;
+    try {
+        // map the CSV file and index its rows in parallel
+        csv::MappedParser file(csvPath, ',', threads);
+        mapped = true;
+        file.project(columns);
+        showHeader(file.getHeader());
+
+        file.forEachRow(parse, store, threads);
+        return;
+    } catch (csv::Error &e) {
+        if (mapped) {
+            throw;
+        }
+    }
+
+    // stream it instead; a missing file fails here too
+    csv::Reader file(csvPath);
+    file.project(columns);
+    showHeader(file.getHeader());
+
+    file.forEachRow([&](const csv::RowView &row) {
+        ParsedBid parsed = parse(row);
+        store(parsed);
+    });
+}
+
 /**
  * Load a CSV file containing bids into a container
  *
@@ -370,59 +525,67 @@ void displayBid(Bid bid) {
  * @return a container holding all the bids read
  */
 void loadBids(string csvPath, BinarySearchTree* bst) {
-    cout << "Loading CSV file " << csvPath << endl;
-
-    // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+    // a current snapshot compiled from this CSV skips parsing altogether
+    string snapshotPath = csvPath + ".snap";
+    try {
+        BidSnapshot snapshot(snapshotPath, csvPath);
 
-    // read and display header row - optional
-    vector<string> header = file.getHeader();
-    for (auto const& c : header) {
-        cout << c << " | ";
+        cout << "Loading snapshot " << snapshotPath << endl;
+        for (size_t i = 0; i < snapshot.Size(); i++) {
+            bst->Insert(snapshotBid(snapshot, i));
+        }
+        return;
+    } catch (SnapshotError &e) {
+        // missing or out of date, read the CSV instead
     }
-    cout << "" << endl;
 
-    try {
-        // loop to read rows of a CSV file
-        for (unsigned int i = 0; i < file.rowCount(); i++) {
+    cout << "Loading CSV file " << csvPath << endl;
+
+    // the bids read are compiled into a snapshot for the next load
+    BidSnapshotWriter compiled;
+    unsigned int skipped = 0;
 
-            // Create a data structure and add to the collection of bids
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+    try {
+        // each bid arrives here, one at a time in file order
+        readBids(csvPath, [&](ParsedBid &parsed) {
+            // rows without a numeric auction id can't be stored
+            if (parsed.bidId == 0) {
+                skipped++;
+                return;
+            }
 
-            //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
+            // initialize a bid using data from the current row
+            Bid bid(parsed.bidId, parsed.title, parsed.fund, parsed.cents);
 
             // push this bid to the end
             bst->Insert(bid);
-        }
+            compiled.Add(bid.bidId, bid.cents, parsed.title, parsed.fund);
+        });
+
+        compiled.Write(snapshotPath, csvPath);
+    } catch (SnapshotError &e) {
+        std::cerr << e.what() << std::endl;
     } catch (csv::Error &e) {
         std::cerr << e.what() << std::endl;
     }
-}
 
-/**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
- *
- * credit: http://stackoverflow.com/a/24875936
- *
- * @param ch The character to strip out
- */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+    // reported even when a damaged file stopped the load part way
+    if (skipped > 0) {
+        cout << skipped << " rows skipped, auction id is missing or not a 32-bit number" << endl;
+    }
 }
 
 /**
  * The one and only main() method
+ *
+ * @param arg[1] path to CSV file to load from (optional)
+ * @param arg[2] the bid Id to use when searching the tree (optional)
+ * @param arg[3] "filtered" to put a Bloom filter in front of Search (optional)
  */
 int main(int argc, char* argv[]) {
 
     // process command line arguments
-    string csvPath, bidKey;
+    string csvPath, bidKey, treeType;
     switch (argc) {
     case 2:
         csvPath = argv[1];
@@ -432,17 +595,29 @@ int main(int argc, char* argv[]) {
         csvPath = argv[1];
         bidKey = argv[2];
         break;
+    case 4:
+        csvPath = argv[1];
+        bidKey = argv[2];
+        treeType = argv[3];
+        break;
     default:
         csvPath = "eBid_Monthly_Sales.csv";
         bidKey = "98223";
     }
 
+    // auction ids are numeric, so the key is parsed once up front
+    uint32_t bidId = 0;
+    parseBidId(bidKey, bidId);
+
     // Define a timer variable
     clock_t ticks;
 
     // Define a binary search tree to hold all bids
     BinarySearchTree* bst;
     bst = new BinarySearchTree();
+    if (treeType == "filtered") {
+        bst->SetFilter(DEFAULT_FALSE_POSITIVE_RATE, 0);
+    }
     Bid bid;
 
     int choice = 0;
@@ -452,6 +627,7 @@ int main(int argc, char* argv[]) {
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
+        cout << "  5. Display Filter Statistics" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -466,8 +642,6 @@ int main(int argc, char* argv[]) {
             // Complete the method call to load the bids
             loadBids(csvPath, bst);
 
-            //cout << bst->Size() << " bids read" << endl;
-
             // Calculate elapsed time and display result
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
             cout << "time: " << ticks << " clock ticks" << endl;
@@ -481,11 +655,11 @@ int main(int argc, char* argv[]) {
         case 3:
             ticks = clock();
 
-            bid = bst->Search(bidKey);
+            bid = bst->Search(bidId);
 
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
-            if (!bid.bidId.empty()) {
+            if (bid.bidId != 0) {
                 displayBid(bid);
             } else {
             	cout << "Bid Id " << bidKey << " not found." << endl;
@@ -497,7 +671,11 @@ int main(int argc, char* argv[]) {
             break;
 
         case 4:
-            bst->Remove(bidKey);
+            bst->Remove(bidId);
+            break;
+
+        case 5:
+            bst->PrintFilter();
             break;
         }
     }
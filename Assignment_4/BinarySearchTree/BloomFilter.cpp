@@ -0,0 +1,216 @@
+//============================================================================
+// Name        : BloomFilter.cpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Blocked Bloom filter over bid ids
+//============================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "BloomFilter.hpp"
+
+using namespace std;
+
+namespace {
+
+/**
+ * The murmur3 finalizer. The top half of the mixed id picks the block;
+ * mixing it again with a counter gives the bits inside the block.
+ */
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * The false positive rate of a blocked filter. The ids in a block
+ * follow a Poisson distribution, and a block holding i of them answers
+ * like a plain Bloom filter of its size holding i ids.
+ *
+ * @param bitsPerId Filter bits for each id
+ * @param blockBits Bits in a block
+ * @param hashes Bits set per id
+ */
+double blockedRate(double bitsPerId, unsigned int blockBits, unsigned int hashes) {
+    double mean = blockBits / bitsPerId;
+    double rate = 0.0;
+    double weight = exp(-mean);     // chance of i ids in a block
+    size_t last = static_cast<size_t>(mean + 8 * sqrt(mean) + 16);
+
+    for (size_t i = 0; i <= last; i++) {
+        double unset = pow(1.0 - 1.0 / blockBits, static_cast<double>(hashes) * i);
+        rate += weight * pow(1.0 - unset, hashes);
+        weight *= mean / (i + 1);
+    }
+    return rate;
+}
+
+/**
+ * The number of bits per id, from 1 to 16, that lets the fewest absent
+ * ids through
+ */
+unsigned int bestHashes(double bitsPerId, unsigned int blockBits) {
+    unsigned int best = 1;
+    for (unsigned int k = 2; k <= 16; k++) {
+        if (blockedRate(bitsPerId, blockBits, k) < blockedRate(bitsPerId, blockBits, best)) {
+            best = k;
+        }
+    }
+    return best;
+}
+
+}
+
+/**
+ * Constructor
+ *
+ * @param aCapacity How many ids will be added
+ * @param aFalsePositiveRate The share of absent ids allowed through,
+ *        between one in a million and one half
+ * @param aMaxBytes Most memory to use, 0 for no limit; a filter held to
+ *        less than the rate needs lets more absent ids through
+ */
+BloomFilter::BloomFilter(size_t aCapacity, double aFalsePositiveRate, size_t aMaxBytes) {
+    falsePositiveRate = min(0.5, max(1e-6, aFalsePositiveRate));
+    maxBytes = aMaxBytes;
+    rejected = 0;
+    passed = 0;
+    falsePositives = 0;
+    Reset(aCapacity);
+}
+
+/**
+ * Clear the filter and size it for a new number of ids, keeping the
+ * rate, the memory limit and the counters
+ *
+ * @param aCapacity How many ids will be added
+ */
+void BloomFilter::Reset(size_t aCapacity) {
+    capacity = max<size_t>(aCapacity, 1);
+    count = 0;
+
+    // start from the size of a plain Bloom filter and add room until
+    // the uneven load of the blocks is made up for
+    const double LN2 = 0.6931471805599453;
+    double bitsPerId = -log(falsePositiveRate) / (LN2 * LN2);
+    while (bitsPerId < 64
+            && blockedRate(bitsPerId, BLOCK_BITS, bestHashes(bitsPerId, BLOCK_BITS)) > falsePositiveRate) {
+        bitsPerId *= 1.05;
+    }
+
+    size_t blockCount = static_cast<size_t>(ceil(capacity * bitsPerId / BLOCK_BITS));
+    if (maxBytes != 0) {
+        blockCount = min(blockCount, maxBytes / sizeof(Block));
+    }
+    blockCount = max<size_t>(blockCount, 1);
+
+    // the best number of bits per id for the room there is
+    hashes = bestHashes(static_cast<double>(blockCount) * BLOCK_BITS / capacity, BLOCK_BITS);
+
+    blocks.assign(blockCount, Block());
+}
+
+/**
+ * Add an id
+ */
+void BloomFilter::Add(uint32_t bidId) {
+    uint64_t h = mix(bidId);
+    Block& block = blocks[((h >> 32) * blocks.size()) >> 32];
+
+    // each bit has its own 9 bits of hash, seven to a 64-bit word
+    uint64_t bits = 0;
+    for (unsigned int i = 0; i < hashes; i++, bits >>= 9) {
+        if (i % 7 == 0) {
+            bits = mix(h + 1 + i / 7);
+        }
+        uint32_t pos = static_cast<uint32_t>(bits) & (BLOCK_BITS - 1);
+        block.words[pos >> 6] |= uint64_t(1) << (pos & 63);
+    }
+    count++;
+}
+
+/**
+ * Check for an id
+ *
+ * @return false if the id was certainly never added
+ */
+bool BloomFilter::MayContain(uint32_t bidId) {
+    uint64_t h = mix(bidId);
+    const Block& block = blocks[((h >> 32) * blocks.size()) >> 32];
+
+    uint64_t bits = 0;
+    for (unsigned int i = 0; i < hashes; i++, bits >>= 9) {
+        if (i % 7 == 0) {
+            bits = mix(h + 1 + i / 7);
+        }
+        uint32_t pos = static_cast<uint32_t>(bits) & (BLOCK_BITS - 1);
+        if ((block.words[pos >> 6] & (uint64_t(1) << (pos & 63))) == 0) {
+            rejected++;
+            return false;
+        }
+    }
+    passed++;
+    return true;
+}
+
+/**
+ * Note that an id the filter let through was not there after all
+ */
+void BloomFilter::CountFalsePositive() {
+    falsePositives++;
+}
+
+/**
+ * Returns true once more ids were added than the filter was sized for
+ */
+bool BloomFilter::Full() const {
+    return count > capacity;
+}
+
+size_t BloomFilter::Capacity() const {
+    return capacity;
+}
+
+size_t BloomFilter::Bytes() const {
+    return blocks.size() * sizeof(Block);
+}
+
+uint64_t BloomFilter::Rejected() const {
+    return rejected;
+}
+
+uint64_t BloomFilter::Passed() const {
+    return passed;
+}
+
+uint64_t BloomFilter::FalsePositives() const {
+    return falsePositives;
+}
+
+/**
+ * Returns the size and counters as readable lines of text
+ */
+string BloomFilter::Text() const {
+    ostringstream out;
+
+    out << "Filter statistics" << endl;
+    out << "  ids: " << count << " of " << capacity << endl;
+    out << "  bytes used: " << Bytes() << ", " << hashes << " bits set per id" << endl;
+    out << "  searches rejected: " << rejected << endl;
+    out << "  searches passed: " << passed << ", " << falsePositives << " false positives" << endl;
+
+    // the share of absent ids let through
+    if (rejected + falsePositives != 0) {
+        out << "  false positive rate: "
+                << static_cast<double>(falsePositives) / (rejected + falsePositives)
+                << " (target " << falsePositiveRate << ")" << endl;
+    }
+    return out.str();
+}
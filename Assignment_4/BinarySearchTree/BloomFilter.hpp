@@ -0,0 +1,67 @@
+//============================================================================
+// Name        : BloomFilter.hpp
+// Author      : Ishmael Kwayisi
+// Version     : 1.0
+// Copyright   : Copyright © 2023 SNHU COCE
+// Description : Blocked Bloom filter over bid ids
+//============================================================================
+
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A blocked Bloom filter over bid ids, kept in front of a container so
+ * a search for an id that was never added can be answered without
+ * touching the container.
+ *
+ * Every id sets a few bits, all in one 64 byte block, so a query reads
+ * a single cache line. MayContain never answers false for an id that
+ * was added; it answers true for an id that was not with about the
+ * configured false positive rate, as long as no more ids than the
+ * capacity are added.
+ *
+ * Ids can't be taken out. The owner rebuilds the filter with Reset and
+ * Add when it is full, which also drops the ids removed since.
+ */
+class BloomFilter {
+
+private:
+    static constexpr unsigned int BLOCK_BITS = 512;
+
+    struct alignas(64) Block {
+        uint64_t words[BLOCK_BITS / 64];
+    };
+
+    std::vector<Block> blocks;
+    unsigned int hashes;        // bits set per id
+    size_t capacity;            // ids it is sized for
+    size_t count;               // ids added since the last reset
+    double falsePositiveRate;
+    size_t maxBytes;            // 0 for no limit
+
+    // cumulative over every MayContain
+    uint64_t rejected;
+    uint64_t passed;
+    uint64_t falsePositives;
+
+public:
+    BloomFilter(size_t aCapacity, double aFalsePositiveRate, size_t aMaxBytes = 0);
+    void Reset(size_t aCapacity);
+    void Add(uint32_t bidId);
+    bool MayContain(uint32_t bidId);
+    void CountFalsePositive();
+    bool Full() const;
+    size_t Capacity() const;
+    size_t Bytes() const;
+    uint64_t Rejected() const;
+    uint64_t Passed() const;
+    uint64_t FalsePositives() const;
+    std::string Text() const;
+};
+
+#endif // BLOOMFILTER_HPP